@@ -7,10 +7,11 @@
 //
 
 #import <Cocoa/Cocoa.h>
+#import "FetchStream.h"
 
 @import Diffusion;
 
-@interface AppDelegate : NSObject <NSApplicationDelegate, PTDiffusionJSONValueStreamDelegate, PTDiffusionFetchStreamDelegate, PTDiffusionSessionResponseStreamDelegate>
+@interface AppDelegate : NSObject <NSApplicationDelegate, PTDiffusionJSONValueStreamDelegate, PTDiffusionFetchStreamDelegate, PTDiffusionSessionResponseStreamDelegate, FetchStreamDelegate>
 
 
 @end
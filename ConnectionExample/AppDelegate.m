@@ -23,6 +23,8 @@ static NSString *const _TopicSelectorExpression = @"*Demos/Sportsbook/Football/E
 
 static NSString *const _TopicSelectorExpressionForAll = @"*Demos//";
 
+static const UInt32 _FetchPageSize = 500;
+
 
 -(void) startWithURL:(NSURL*)url
 {
@@ -42,19 +44,12 @@ static NSString *const _TopicSelectorExpressionForAll = @"*Demos//";
         PTDiffusionValueStream *const stream = [PTDiffusionJSON valueStreamWithDelegate:self];
         [session.topics addFallbackStream:stream];
         
-        [[session.topics fetchRequest] fetchWithTopicSelectorExpression:_TopicSelectorExpressionForAll completionHandler:^(PTDiffusionFetchResult * _Nullable result, NSError * _Nullable error) {
-            if (error)
-            {
-                NSLog(@"Error while fetching: %@", error);
-            }
-            else
-            {
-                for (PTDiffusionFetchTopicResult * topicResult in result.results)
-                {
-                    NSLog(@"Fetch Topic Result: %@", topicResult.path);
-                }
-            }
-        }];
+        FetchStream *const fetchStream =
+            [[FetchStream alloc] initWithRequest:[session.topics fetchRequest]
+                                        pageSize:_FetchPageSize
+                                     pageFetcher:[FetchStream pageFetcherWithTopicSelectorExpression:_TopicSelectorExpressionForAll]
+                                        delegate:self];
+        [fetchStream start];
         
         
         [self performSelector:@selector(subscribe:) withObject:session afterDelay:2.0];
@@ -141,6 +136,18 @@ static NSString *const _TopicSelectorExpressionForAll = @"*Demos//";
     NSLog(@"\tFetch result: %@ = %@", topicPath, content);
 }
 
+- (void)fetchStream:(nonnull FetchStream *)stream didFetchTopicResult:(nonnull PTDiffusionFetchTopicResult *)result {
+    NSLog(@"Fetch Topic Result: %@", result.path);
+}
+
+- (void)fetchStreamDidComplete:(nonnull FetchStream *)stream {
+    NSLog(@"Fetch complete: %lu topics", (unsigned long)stream.resultCount);
+}
+
+- (void)fetchStream:(nonnull FetchStream *)stream didFailWithError:(nonnull NSError *)error {
+    NSLog(@"Error while fetching: %@", error);
+}
+
 - (void)diffusionStream:(nonnull PTDiffusionStream *)stream didReceiveError:(nonnull NSError *)error fromSessionId:(nonnull PTDiffusionSessionId *)sessionId {
     NSLog(@"\tSession Error:%@", error);
 }
@@ -0,0 +1,98 @@
+//
+//  ColumnarFetchResult.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, ColumnarFetchValueType) {
+    ColumnarFetchValueType_Int64,
+    ColumnarFetchValueType_Double,
+    /** Values are held as UTF-8 in valueArena. Fetch only. */
+    ColumnarFetchValueType_String,
+};
+
+/**
+ The results of a numeric or string fetch held as columns rather than as one
+ object per topic.
+
+ Paths are stored back to back as UTF-8 in a single arena; the path of result
+ `i` is the `pathOffsets[i + 1] - pathOffsets[i]` bytes starting at
+ `pathArena + pathOffsets[i]`. Numeric values are stored in one contiguous
+ array of the fetched type and string values in a second arena laid out like
+ the paths, with `hasValue[i]` false for topics that have no value.
+
+ Instances are immutable and can be shared between threads.
+ */
+@interface ColumnarFetchResult : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Pages through a fetch and decodes every page into columns on a
+ background queue, releasing the per-topic result objects a page at a time.
+ Must be called on the main queue; the completion handler is called on the main
+ queue.
+
+ @param request The request to page through; see FetchStream.
+ @param expression The topic selector.
+ @param valueType Selects fetchInt64NumberValuesWithTopicSelectorExpression:,
+ fetchDoubleFloatNumberValuesWithTopicSelectorExpression: or
+ fetchStringValuesWithTopicSelectorExpression:
+ @param pageSize The number of results fetched per page.
+ */
++ (void)fetchWithRequest:(PTDiffusionFetchRequest *)request
+ topicSelectorExpression:(NSString *)expression
+               valueType:(ColumnarFetchValueType)valueType
+                pageSize:(UInt32)pageSize
+       completionHandler:(void (^)(ColumnarFetchResult * _Nullable result, NSError * _Nullable error))completionHandler;
+
+@property (nonatomic, readonly) ColumnarFetchValueType valueType;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+@property (nonatomic, readonly) const char *pathArena;
+
+/**
+ `count + 1` offsets into pathArena.
+ */
+@property (nonatomic, readonly) const uint32_t *pathOffsets;
+
+/**
+ The values if valueType is ColumnarFetchValueType_Int64, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const int64_t *int64Values;
+
+/**
+ The values if valueType is ColumnarFetchValueType_Double, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const double *doubleValues;
+
+/**
+ The values if valueType is ColumnarFetchValueType_String, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const char *valueArena;
+
+/**
+ `count + 1` offsets into valueArena if valueType is
+ ColumnarFetchValueType_String, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const uint32_t *valueOffsets;
+
+@property (nonatomic, readonly) const bool *hasValue;
+
+/**
+ Creates a string for the path at the given index.
+ */
+- (NSString *)pathAtIndex:(NSUInteger)index;
+
+@end
+
+NS_ASSUME_NONNULL_END
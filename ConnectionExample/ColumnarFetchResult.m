@@ -0,0 +1,210 @@
+//
+//  ColumnarFetchResult.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ColumnarFetchResult.h"
+#import "FetchStream.h"
+#import "UTF8StringStream.h"
+
+
+@interface ColumnarFetchResult ()
+
+- (instancetype)initWithValueType:(ColumnarFetchValueType)valueType NS_DESIGNATED_INITIALIZER;
+
+- (void)appendTopicResult:(PTDiffusionFetchTopicResult *)result;
+
+@end
+
+
+/**
+ Feeds each fetched topic into a result under construction. Runs on the
+ decoding queue.
+ */
+@interface ColumnarFetchResultDecoder : NSObject <FetchStreamDelegate>
+
+@property (nonatomic) ColumnarFetchResult *result;
+@property (nonatomic, copy) void (^completionHandler)(ColumnarFetchResult * _Nullable result, NSError * _Nullable error);
+
+@end
+
+@implementation ColumnarFetchResultDecoder
+
+- (void)fetchStream:(FetchStream *const)stream didFetchTopicResult:(PTDiffusionFetchTopicResult *const)result {
+    [_result appendTopicResult:result];
+}
+
+- (void)fetchStreamDidComplete:(FetchStream *const)stream {
+    ColumnarFetchResult *const result = _result;
+    void (^const completionHandler)(ColumnarFetchResult *, NSError *) = _completionHandler;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(result, nil);
+    });
+}
+
+- (void)fetchStream:(FetchStream *const)stream didFailWithError:(NSError *const)error {
+    void (^const completionHandler)(ColumnarFetchResult *, NSError *) = _completionHandler;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(nil, error);
+    });
+}
+
+@end
+
+
+@implementation ColumnarFetchResult {
+    NSMutableData *_arena;
+    NSMutableData *_offsets;
+    NSMutableData *_values;
+    NSMutableData *_valueOffsets;
+    NSMutableData *_present;
+    // Holds strings that must be encoded rather than copied.
+    NSMutableData *_encodingBuffer;
+}
+
+
++ (void)fetchWithRequest:(PTDiffusionFetchRequest *const)request
+ topicSelectorExpression:(NSString *const)expression
+               valueType:(const ColumnarFetchValueType)valueType
+                pageSize:(const UInt32)pageSize
+       completionHandler:(void (^const)(ColumnarFetchResult *, NSError *))completionHandler {
+    NSString *const selector = [expression copy];
+    FetchStreamPageFetcher pageFetcher;
+    if (ColumnarFetchValueType_Int64 == valueType) {
+        pageFetcher = ^(PTDiffusionFetchRequest *const pageRequest, void (^const pageHandler)(PTDiffusionFetchResult *, NSError *)) {
+            [pageRequest fetchInt64NumberValuesWithTopicSelectorExpression:selector completionHandler:pageHandler];
+        };
+    } else if (ColumnarFetchValueType_Double == valueType) {
+        pageFetcher = ^(PTDiffusionFetchRequest *const pageRequest, void (^const pageHandler)(PTDiffusionFetchResult *, NSError *)) {
+            [pageRequest fetchDoubleFloatNumberValuesWithTopicSelectorExpression:selector completionHandler:pageHandler];
+        };
+    } else {
+        pageFetcher = ^(PTDiffusionFetchRequest *const pageRequest, void (^const pageHandler)(PTDiffusionFetchResult *, NSError *)) {
+            [pageRequest fetchStringValuesWithTopicSelectorExpression:selector completionHandler:pageHandler];
+        };
+    }
+
+    ColumnarFetchResultDecoder *const decoder = [ColumnarFetchResultDecoder new];
+    decoder.result = [[ColumnarFetchResult alloc] initWithValueType:valueType];
+    decoder.completionHandler = completionHandler;
+
+    FetchStream *const stream = [[FetchStream alloc] initWithRequest:request
+                                                            pageSize:pageSize
+                                                         pageFetcher:pageFetcher
+                                                            delegate:decoder];
+    stream.delegateQueue = dispatch_queue_create("ColumnarFetchResult.decode", DISPATCH_QUEUE_SERIAL);
+    [stream start];
+}
+
+
+- (instancetype)initWithValueType:(const ColumnarFetchValueType)valueType {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _valueType = valueType;
+    _arena = [NSMutableData new];
+    _offsets = [NSMutableData new];
+    _values = [NSMutableData new];
+    _present = [NSMutableData new];
+    _encodingBuffer = [NSMutableData new];
+    const uint32_t start = 0;
+    [_offsets appendBytes:&start length:sizeof(start)];
+    if (ColumnarFetchValueType_String == valueType) {
+        _valueOffsets = [NSMutableData new];
+        [_valueOffsets appendBytes:&start length:sizeof(start)];
+    }
+    return self;
+}
+
+
+- (void)appendString:(NSString *const)string toArena:(NSMutableData *const)arena offsets:(NSMutableData *const)offsets {
+    const UTF8StringSlice slice = [UTF8StringValueStream sliceOfString:string buffer:_encodingBuffer];
+    if (arena.length + slice.length > UINT32_MAX) {
+        [NSException raise:NSRangeException format:@"Arena exceeds 4GB"];
+    }
+    [arena appendBytes:slice.bytes length:slice.length];
+    const uint32_t end = (uint32_t)arena.length;
+    [offsets appendBytes:&end length:sizeof(end)];
+}
+
+
+- (void)appendTopicResult:(PTDiffusionFetchTopicResult *const)result {
+    [self appendString:result.path toArena:_arena offsets:_offsets];
+
+    if (ColumnarFetchValueType_String == _valueType) {
+        NSString *string = nil;
+        if ([result isKindOfClass:[PTDiffusionStringFetchTopicResult class]]) {
+            string = ((PTDiffusionStringFetchTopicResult *)result).string;
+        }
+        const bool present = nil != string;
+        [_present appendBytes:&present length:sizeof(present)];
+        [self appendString:string toArena:_values offsets:_valueOffsets];
+        ++_count;
+        return;
+    }
+
+    NSNumber *number = nil;
+    if ([result isKindOfClass:[PTDiffusionNumberFetchTopicResult class]]) {
+        number = ((PTDiffusionNumberFetchTopicResult *)result).number;
+    }
+    const bool present = nil != number;
+    [_present appendBytes:&present length:sizeof(present)];
+    if (ColumnarFetchValueType_Int64 == _valueType) {
+        const int64_t value = number.longLongValue;
+        [_values appendBytes:&value length:sizeof(value)];
+    } else {
+        const double value = number.doubleValue;
+        [_values appendBytes:&value length:sizeof(value)];
+    }
+    ++_count;
+}
+
+
+- (const char *)pathArena {
+    return _arena.bytes;
+}
+
+
+- (const uint32_t *)pathOffsets {
+    return _offsets.bytes;
+}
+
+
+- (const int64_t *)int64Values {
+    return ColumnarFetchValueType_Int64 == _valueType ? _values.bytes : NULL;
+}
+
+
+- (const double *)doubleValues {
+    return ColumnarFetchValueType_Double == _valueType ? _values.bytes : NULL;
+}
+
+
+- (const char *)valueArena {
+    return ColumnarFetchValueType_String == _valueType ? _values.bytes : NULL;
+}
+
+
+- (const uint32_t *)valueOffsets {
+    return _valueOffsets.bytes;
+}
+
+
+- (const bool *)hasValue {
+    return _present.bytes;
+}
+
+
+- (NSString *)pathAtIndex:(const NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"Index %lu beyond count %lu", (unsigned long)index, (unsigned long)_count];
+    }
+    const uint32_t *const offsets = _offsets.bytes;
+    return [[NSString alloc] initWithBytes:(const char *)_arena.bytes + offsets[index]
+                                    length:offsets[index + 1] - offsets[index]
+                                  encoding:NSUTF8StringEncoding];
+}
+
+@end
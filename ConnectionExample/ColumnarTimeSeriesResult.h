@@ -0,0 +1,87 @@
+//
+//  ColumnarTimeSeriesResult.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ColumnarFetchResult.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The events of a numeric time series range query held as columns rather than
+ as one PTDiffusionNumberTimeSeriesEvent per event.
+
+ Event `i` has `sequences[i]`, `timestamps[i]` and the author
+ `authors[authorIndexes[i]]`. Values are stored in one contiguous array of the
+ queried type, with `hasValue[i]` false for events whose value is null. Each
+ distinct author is stored once.
+
+ Instances are immutable and can be shared between threads.
+ */
+@interface ColumnarTimeSeriesResult : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Pages through a range query with a TimeSeriesQueryStream and decodes every
+ page into columns on a background queue, releasing the event objects a page
+ at a time. Must be called on the main queue; the completion handler is called
+ on the main queue.
+
+ @param query The query to page through; see TimeSeriesQueryStream.
+ @param session The session to evaluate the query with.
+ @param topicPath The path of an int64 or double time series topic.
+ @param valueType Selects the int64 or double form of evaluateQuery:
+ @param pageSize The number of events requested per page.
+ @exception NSInvalidArgumentException If valueType is
+ ColumnarFetchValueType_String.
+ */
++ (void)evaluateQuery:(PTDiffusionTimeSeriesRangeQuery *)query
+          withSession:(PTDiffusionSession *)session
+          atTopicPath:(NSString *)topicPath
+            valueType:(ColumnarFetchValueType)valueType
+             pageSize:(UInt32)pageSize
+    completionHandler:(void (^)(ColumnarTimeSeriesResult * _Nullable result, NSError * _Nullable error))completionHandler;
+
+/**
+ Decodes an already evaluated query result. Can be called on any queue.
+ */
++ (instancetype)resultWithQueryResult:(PTDiffusionNumberTimeSeriesQueryResult *)queryResult
+                            valueType:(ColumnarFetchValueType)valueType;
+
+@property (nonatomic, readonly) ColumnarFetchValueType valueType;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+@property (nonatomic, readonly) const uint64_t *sequences;
+
+/**
+ Milliseconds since the epoch, as PTDiffusionTimeSeriesEventMetadata#timestamp.
+ */
+@property (nonatomic, readonly) const int64_t *timestamps;
+
+@property (nonatomic, readonly) const uint32_t *authorIndexes;
+
+@property (nonatomic, readonly) NSArray<NSString *> *authors;
+
+/**
+ The values if valueType is ColumnarFetchValueType_Int64, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const int64_t *int64Values;
+
+/**
+ The values if valueType is ColumnarFetchValueType_Double, otherwise `NULL`.
+ */
+@property (nonatomic, readonly, nullable) const double *doubleValues;
+
+@property (nonatomic, readonly) const bool *hasValue;
+
+@end
+
+NS_ASSUME_NONNULL_END
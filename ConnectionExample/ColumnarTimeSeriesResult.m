@@ -0,0 +1,208 @@
+//
+//  ColumnarTimeSeriesResult.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ColumnarTimeSeriesResult.h"
+#import "TimeSeriesQueryStream.h"
+
+
+@interface ColumnarTimeSeriesResult ()
+
+- (instancetype)initWithValueType:(ColumnarFetchValueType)valueType NS_DESIGNATED_INITIALIZER;
+
+- (void)appendEvent:(PTDiffusionNumberTimeSeriesEvent *)event;
+
+/**
+ Called once the last event has been appended.
+ */
+- (void)finishBuilding;
+
+@end
+
+
+/**
+ Feeds each event into a result under construction. Runs on the decoding
+ queue.
+ */
+@interface ColumnarTimeSeriesResultDecoder : NSObject <TimeSeriesQueryStreamDelegate>
+
+@property (nonatomic) ColumnarTimeSeriesResult *result;
+@property (nonatomic, copy) void (^completionHandler)(ColumnarTimeSeriesResult * _Nullable result, NSError * _Nullable error);
+
+@end
+
+@implementation ColumnarTimeSeriesResultDecoder
+
+- (void)timeSeriesQueryStream:(TimeSeriesQueryStream *const)stream didReceiveEvent:(PTDiffusionTimeSeriesEvent *const)event {
+    [_result appendEvent:(PTDiffusionNumberTimeSeriesEvent *)event];
+}
+
+- (void)timeSeriesQueryStreamDidComplete:(TimeSeriesQueryStream *const)stream {
+    ColumnarTimeSeriesResult *const result = _result;
+    [result finishBuilding];
+    void (^const completionHandler)(ColumnarTimeSeriesResult *, NSError *) = _completionHandler;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(result, nil);
+    });
+}
+
+- (void)timeSeriesQueryStream:(TimeSeriesQueryStream *const)stream didFailWithError:(NSError *const)error {
+    void (^const completionHandler)(ColumnarTimeSeriesResult *, NSError *) = _completionHandler;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(nil, error);
+    });
+}
+
+@end
+
+
+@implementation ColumnarTimeSeriesResult {
+    NSMutableData *_sequences;
+    NSMutableData *_timestamps;
+    NSMutableData *_authorIndexes;
+    NSMutableArray<NSString *> *_authorNames;
+    NSArray<NSString *> *_authors;
+    NSMutableDictionary<NSString *, NSNumber *> *_authorIndexByName;
+    NSMutableData *_values;
+    NSMutableData *_present;
+}
+
+
++ (void)evaluateQuery:(PTDiffusionTimeSeriesRangeQuery *const)query
+          withSession:(PTDiffusionSession *const)session
+          atTopicPath:(NSString *const)topicPath
+            valueType:(const ColumnarFetchValueType)valueType
+             pageSize:(const UInt32)pageSize
+    completionHandler:(void (^const)(ColumnarTimeSeriesResult *, NSError *))completionHandler {
+    const TimeSeriesQueryStreamPageEvaluator pageEvaluator = ColumnarFetchValueType_Int64 == valueType
+        ? [TimeSeriesQueryStream int64PageEvaluatorWithSession:session topicPath:topicPath]
+        : [TimeSeriesQueryStream doublePageEvaluatorWithSession:session topicPath:topicPath];
+
+    ColumnarTimeSeriesResultDecoder *const decoder = [ColumnarTimeSeriesResultDecoder new];
+    decoder.result = [[ColumnarTimeSeriesResult alloc] initWithValueType:valueType];
+    decoder.completionHandler = completionHandler;
+
+    TimeSeriesQueryStream *const stream = [[TimeSeriesQueryStream alloc] initWithQuery:query
+                                                                              pageSize:pageSize
+                                                                         pageEvaluator:pageEvaluator
+                                                                              delegate:decoder];
+    stream.delegateQueue = dispatch_queue_create("ColumnarTimeSeriesResult.decode", DISPATCH_QUEUE_SERIAL);
+    [stream start];
+}
+
+
++ (instancetype)resultWithQueryResult:(PTDiffusionNumberTimeSeriesQueryResult *const)queryResult
+                            valueType:(const ColumnarFetchValueType)valueType {
+    ColumnarTimeSeriesResult *const result = [[self alloc] initWithValueType:valueType];
+    NSArray<PTDiffusionNumberTimeSeriesEvent *> *const events = queryResult.numberEvents;
+    [result reserveCapacity:events.count];
+    for (PTDiffusionNumberTimeSeriesEvent *const event in events) {
+        [result appendEvent:event];
+    }
+    [result finishBuilding];
+    return result;
+}
+
+
+- (instancetype)initWithValueType:(const ColumnarFetchValueType)valueType {
+    if (ColumnarFetchValueType_String == valueType) {
+        [NSException raise:NSInvalidArgumentException format:@"Time series results are numeric only"];
+    }
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _valueType = valueType;
+    _sequences = [NSMutableData new];
+    _timestamps = [NSMutableData new];
+    _authorIndexes = [NSMutableData new];
+    _authorNames = [NSMutableArray new];
+    _authors = @[];
+    _authorIndexByName = [NSMutableDictionary new];
+    _values = [NSMutableData new];
+    _present = [NSMutableData new];
+    return self;
+}
+
+
+- (void)reserveCapacity:(const NSUInteger)count {
+    _sequences = [NSMutableData dataWithCapacity:count * sizeof(uint64_t)];
+    _timestamps = [NSMutableData dataWithCapacity:count * sizeof(int64_t)];
+    _authorIndexes = [NSMutableData dataWithCapacity:count * sizeof(uint32_t)];
+    _values = [NSMutableData dataWithCapacity:count * sizeof(int64_t)];
+    _present = [NSMutableData dataWithCapacity:count * sizeof(bool)];
+}
+
+
+- (void)appendEvent:(PTDiffusionNumberTimeSeriesEvent *const)event {
+    const uint64_t sequence = event.sequence;
+    [_sequences appendBytes:&sequence length:sizeof(sequence)];
+    const int64_t timestamp = event.timestamp;
+    [_timestamps appendBytes:&timestamp length:sizeof(timestamp)];
+
+    NSString *const author = event.author;
+    NSNumber *index = _authorIndexByName[author];
+    if (!index) {
+        index = @(_authorNames.count);
+        [_authorNames addObject:author];
+        _authorIndexByName[author] = index;
+    }
+    const uint32_t authorIndex = index.unsignedIntValue;
+    [_authorIndexes appendBytes:&authorIndex length:sizeof(authorIndex)];
+
+    NSNumber *const number = event.number;
+    const bool present = nil != number;
+    [_present appendBytes:&present length:sizeof(present)];
+    if (ColumnarFetchValueType_Int64 == _valueType) {
+        const int64_t value = number.longLongValue;
+        [_values appendBytes:&value length:sizeof(value)];
+    } else {
+        const double value = number.doubleValue;
+        [_values appendBytes:&value length:sizeof(value)];
+    }
+    ++_count;
+}
+
+
+- (void)finishBuilding {
+    _authors = [_authorNames copy];
+}
+
+
+- (const uint64_t *)sequences {
+    return _sequences.bytes;
+}
+
+
+- (const int64_t *)timestamps {
+    return _timestamps.bytes;
+}
+
+
+- (const uint32_t *)authorIndexes {
+    return _authorIndexes.bytes;
+}
+
+
+- (NSArray<NSString *> *)authors {
+    return _authors;
+}
+
+
+- (const int64_t *)int64Values {
+    return ColumnarFetchValueType_Int64 == _valueType ? _values.bytes : NULL;
+}
+
+
+- (const double *)doubleValues {
+    return ColumnarFetchValueType_Double == _valueType ? _values.bytes : NULL;
+}
+
+
+- (const bool *)hasValue {
+    return _present.bytes;
+}
+
+@end
@@ -0,0 +1,61 @@
+//
+//  CompactedTimeSeriesQueryResult.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The latest value view of a time series, built from the result of an edit
+ range query (PTDiffusionTimeSeriesRangeQuery#forEdits with
+ PTDiffusionTimeSeriesRangeQuery#allEdits or PTDiffusionTimeSeriesRangeQuery#latestEdits).
+
+ Each original event is replaced by its latest edit, in one pass over the
+ query result with a hash index on original sequence numbers. Events are in
+ original sequence order. An edit whose original falls before the queried
+ range still appears, in the position of its original.
+
+ Instances are immutable and can be shared between threads.
+ */
+@interface CompactedTimeSeriesQueryResult : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Compacts any of the typed PTDiffusionTimeSeriesQueryResult subclasses. Can
+ be called on any queue.
+ */
++ (instancetype)resultWithQueryResult:(PTDiffusionTimeSeriesQueryResult *)queryResult;
+
+/**
+ Compacts events in sequence order, as returned by an edit range query.
+ */
++ (instancetype)resultWithEvents:(NSArray<PTDiffusionTimeSeriesEvent *> *)events;
+
+/**
+ One event per original event: the original if it has not been edited,
+ otherwise its latest edit.
+ */
+@property (nonatomic, readonly) NSArray<PTDiffusionTimeSeriesEvent *> *events;
+
+/**
+ The number of edit events that replaced an earlier value.
+ */
+@property (nonatomic, readonly) NSUInteger appliedEditCount;
+
+/**
+ The current event for an original sequence number, or `nil` if the result
+ has none.
+ */
+- (nullable PTDiffusionTimeSeriesEvent *)eventForOriginalSequence:(UInt64)sequence;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,87 @@
+//
+//  CompactedTimeSeriesQueryResult.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "CompactedTimeSeriesQueryResult.h"
+#import "TimeSeriesQueryStream.h"
+
+
+// Keys and values are offset by one, as zero means absent.
+static NSMapTable *_IndexTable(const NSUInteger capacity) {
+    const NSPointerFunctionsOptions options = NSPointerFunctionsIntegerPersonality | NSPointerFunctionsOpaqueMemory;
+    return [[NSMapTable alloc] initWithKeyOptions:options valueOptions:options capacity:capacity];
+}
+
+
+@implementation CompactedTimeSeriesQueryResult {
+    // Original sequence + 1 to index into _events + 1.
+    NSMapTable *_index;
+}
+
+
++ (instancetype)resultWithQueryResult:(PTDiffusionTimeSeriesQueryResult *const)queryResult {
+    return [self resultWithEvents:[TimeSeriesQueryStream eventsOfQueryResult:queryResult]];
+}
+
+
++ (instancetype)resultWithEvents:(NSArray<PTDiffusionTimeSeriesEvent *> *const)events {
+    return [[self alloc] initWithEvents:events];
+}
+
+
+- (instancetype)initWithEvents:(NSArray<PTDiffusionTimeSeriesEvent *> *const)sourceEvents {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    NSMutableArray<PTDiffusionTimeSeriesEvent *> *events = [NSMutableArray arrayWithCapacity:sourceEvents.count];
+    NSMapTable *index = _IndexTable(sourceEvents.count);
+    UInt64 lastOriginal = 0;
+    BOOL ordered = YES;
+    for (PTDiffusionTimeSeriesEvent *const event in sourceEvents) {
+        const UInt64 original = event.originalEvent.sequence;
+        const uintptr_t key = (uintptr_t)original + 1;
+        const uintptr_t slot = (uintptr_t)NSMapGet(index, (const void *)key);
+        if (slot) {
+            // Events arrive in sequence order, so a later one is newer.
+            events[slot - 1] = event;
+            if (event.isEditEvent) {
+                ++_appliedEditCount;
+            }
+            continue;
+        }
+        if (events.count > 0 && original < lastOriginal) {
+            ordered = NO;
+        }
+        lastOriginal = original;
+        [events addObject:event];
+        NSMapInsertKnownAbsent(index, (const void *)key, (const void *)(uintptr_t)events.count);
+    }
+
+    // Only edits of originals before the queried range can be out of place.
+    if (!ordered) {
+        [events sortUsingComparator:^NSComparisonResult(PTDiffusionTimeSeriesEvent *const a, PTDiffusionTimeSeriesEvent *const b) {
+            const UInt64 x = a.originalEvent.sequence;
+            const UInt64 y = b.originalEvent.sequence;
+            return x < y ? NSOrderedAscending : x > y ? NSOrderedDescending : NSOrderedSame;
+        }];
+        index = _IndexTable(events.count);
+        NSUInteger position = 0;
+        for (PTDiffusionTimeSeriesEvent *const event in events) {
+            NSMapInsertKnownAbsent(index, (const void *)((uintptr_t)event.originalEvent.sequence + 1), (const void *)(uintptr_t)++position);
+        }
+    }
+    _events = [events copy];
+    _index = index;
+    return self;
+}
+
+
+- (PTDiffusionTimeSeriesEvent *)eventForOriginalSequence:(const UInt64)sequence {
+    const uintptr_t slot = (uintptr_t)NSMapGet(_index, (const void *)((uintptr_t)sequence + 1));
+    return slot ? _events[slot - 1] : nil;
+}
+
+@end
@@ -0,0 +1,109 @@
+//
+//  ConcurrentRequestDispatcher.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+@class ConcurrentResponder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, ConcurrentRequestOrdering) {
+    /**
+     Responses are sent as soon as the worker provides them.
+     */
+    ConcurrentRequestOrdering_Unordered,
+
+    /**
+     Responses are sent in the order the requests were received. A request
+     keeps its slot until its response has been sent, so at most
+     maximumConcurrency responses are ever held back.
+     */
+    ConcurrentRequestOrdering_InOrder,
+};
+
+/**
+ Handles JSON requests. Called on the dispatcher's queue, possibly for several
+ requests at once.
+ */
+@protocol ConcurrentJSONRequestWorker <NSObject>
+
+/**
+ @param context The request context, or `nil` for requests received on a
+ request stream.
+ @param responder Must be sent exactly one respond or reject message, from any
+ thread.
+ */
+- (void)handleRequestWithJSON:(PTDiffusionJSON *)json
+                      context:(nullable PTDiffusionRequestContext *)context
+                    responder:(ConcurrentResponder *)responder;
+
+@end
+
+/**
+ A responder that may be used from any thread.
+ */
+@interface ConcurrentResponder : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)respondWithJSON:(PTDiffusionJSON *)json;
+
+- (void)rejectWithReason:(NSString *)reason;
+
+@end
+
+/**
+ Runs JSON request workers concurrently.
+
+ The client library delivers requests to stream and handler delegates one at a
+ time on the main queue. The dispatcher receives them there, then runs up to
+ maximumConcurrency workers at once on its queue. Requests beyond that wait in
+ arrival order.
+
+ The dispatcher is the delegate of the stream or handler it creates. Those do
+ not retain their delegate, so the dispatcher must be retained for as long as
+ they are registered.
+ */
+@interface ConcurrentRequestDispatcher : NSObject <PTDiffusionJSONRequestStreamDelegate, PTDiffusionJSONRequestDelegate>
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithWorker:(id<ConcurrentJSONRequestWorker>)worker
+            maximumConcurrency:(NSUInteger)maximumConcurrency
+                      ordering:(ConcurrentRequestOrdering)ordering NS_DESIGNATED_INITIALIZER;
+
+/**
+ The queue on which workers are called. Defaults to the global queue for the
+ default quality of service class.
+ */
+@property (nonatomic) dispatch_queue_t queue;
+
+@property (nonatomic, readonly) ConcurrentRequestOrdering ordering;
+
+/**
+ May be changed on the main queue at any time.
+ */
+@property (nonatomic) NSUInteger maximumConcurrency;
+
+/**
+ A stream to register with PTDiffusionMessagingFeature#setRequestStream:forPath:
+ */
+- (PTDiffusionRequestStream *)requestStream;
+
+/**
+ A handler to register with
+ PTDiffusionMessagingControlFeature#addRequestHandler:forPath:completionHandler:
+ */
+- (PTDiffusionRequestHandler *)requestHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,209 @@
+//
+//  ConcurrentRequestDispatcher.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ConcurrentRequestDispatcher.h"
+#import "RequestWindow.h"
+
+
+@interface ConcurrentRequestDispatcher ()
+
+- (void)releaseResponse:(dispatch_block_t)send sequence:(NSUInteger)sequence done:(dispatch_block_t)done;
+
+@end
+
+
+@interface ConcurrentResponder ()
+
+- (instancetype)initWithResponder:(PTDiffusionResponder *)responder
+                         sequence:(NSUInteger)sequence
+                       dispatcher:(ConcurrentRequestDispatcher *)dispatcher
+                             done:(dispatch_block_t)done NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation ConcurrentResponder {
+    PTDiffusionResponder *_responder;
+    NSUInteger _sequence;
+    ConcurrentRequestDispatcher *_dispatcher;
+    dispatch_block_t _done;
+    // Only read and written on the main queue.
+    BOOL _responded;
+}
+
+- (instancetype)initWithResponder:(PTDiffusionResponder *const)responder
+                         sequence:(const NSUInteger)sequence
+                       dispatcher:(ConcurrentRequestDispatcher *const)dispatcher
+                             done:(const dispatch_block_t)done {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _responder = responder;
+    _sequence = sequence;
+    _dispatcher = dispatcher;
+    _done = [done copy];
+    return self;
+}
+
+- (void)respondWithJSON:(PTDiffusionJSON *const)json {
+    PTDiffusionResponder *const responder = _responder;
+    [self complete:^{
+        [responder respondWithJSON:json];
+    }];
+}
+
+- (void)rejectWithReason:(NSString *const)reason {
+    PTDiffusionResponder *const responder = _responder;
+    [self complete:^{
+        [responder rejectWithReason:reason];
+    }];
+}
+
+- (void)complete:(const dispatch_block_t)send {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (self->_responded) {
+            [NSException raise:NSInternalInconsistencyException format:@"Request already responded to"];
+        }
+        self->_responded = YES;
+        [self->_dispatcher releaseResponse:send sequence:self->_sequence done:self->_done];
+        self->_dispatcher = nil;
+        self->_done = nil;
+    });
+}
+
+@end
+
+
+@implementation ConcurrentRequestDispatcher {
+    id<ConcurrentJSONRequestWorker> _worker;
+    RequestWindow *_window;
+    NSUInteger _nextSequence;
+    NSUInteger _nextSequenceToSend;
+    NSMutableDictionary<NSNumber *, dispatch_block_t> *_heldSends;
+    NSMutableDictionary<NSNumber *, dispatch_block_t> *_heldDones;
+}
+
+
+- (instancetype)initWithWorker:(const id<ConcurrentJSONRequestWorker>)worker
+            maximumConcurrency:(const NSUInteger)maximumConcurrency
+                      ordering:(const ConcurrentRequestOrdering)ordering {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _worker = worker;
+    _ordering = ordering;
+    _window = [[RequestWindow alloc] initWithSession:nil maximumOutstandingRequests:maximumConcurrency];
+    _queue = dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0);
+    _heldSends = [NSMutableDictionary new];
+    _heldDones = [NSMutableDictionary new];
+    return self;
+}
+
+
+- (NSUInteger)maximumConcurrency {
+    return _window.maximumOutstandingRequests;
+}
+
+
+- (void)setMaximumConcurrency:(const NSUInteger)maximumConcurrency {
+    _window.maximumOutstandingRequests = maximumConcurrency;
+}
+
+
+- (PTDiffusionRequestStream *)requestStream {
+    return [PTDiffusionJSON requestStreamWithDelegate:self];
+}
+
+
+- (PTDiffusionRequestHandler *)requestHandler {
+    return [PTDiffusionJSON requestHandlerWithDelegate:self];
+}
+
+
+- (void)dispatchRequestWithJSON:(PTDiffusionJSON *const)json
+                        context:(PTDiffusionRequestContext *const)context
+                      responder:(PTDiffusionResponder *const)responder {
+    const NSUInteger sequence = _nextSequence++;
+    const id<ConcurrentJSONRequestWorker> worker = _worker;
+    const dispatch_queue_t queue = _queue;
+    [_window performOperation:^(const dispatch_block_t done) {
+        ConcurrentResponder *const concurrentResponder =
+            [[ConcurrentResponder alloc] initWithResponder:responder
+                                                  sequence:sequence
+                                                dispatcher:self
+                                                      done:done];
+        dispatch_async(queue, ^{
+            [worker handleRequestWithJSON:json context:context responder:concurrentResponder];
+        });
+    }];
+}
+
+
+- (void)releaseResponse:(const dispatch_block_t)send
+               sequence:(const NSUInteger)sequence
+                   done:(const dispatch_block_t)done {
+    if (ConcurrentRequestOrdering_Unordered == _ordering) {
+        send();
+        done();
+        return;
+    }
+
+    _heldSends[@(sequence)] = send;
+    _heldDones[@(sequence)] = done;
+    // Requests are started in sequence order, so every sequence number up to
+    // the latest is either held here or still with a worker.
+    dispatch_block_t next;
+    while ((next = _heldSends[@(_nextSequenceToSend)])) {
+        NSNumber *const key = @(_nextSequenceToSend++);
+        const dispatch_block_t nextDone = _heldDones[key];
+        [_heldSends removeObjectForKey:key];
+        [_heldDones removeObjectForKey:key];
+        next();
+        nextDone();
+    }
+}
+
+
+#pragma mark - PTDiffusionJSONRequestStreamDelegate
+
+- (void)       diffusionStream:(PTDiffusionStream *const)stream
+     didReceiveRequestWithJSON:(PTDiffusionJSON *const)json
+                     responder:(PTDiffusionResponder *const)responder {
+    [self dispatchRequestWithJSON:json context:nil responder:responder];
+}
+
+
+- (void)diffusionStream:(PTDiffusionStream *const)stream didFailWithError:(NSError *const)error {
+    NSLog(@"Request stream failed: %@", error);
+}
+
+
+- (void)diffusionDidCloseStream:(PTDiffusionStream *const)stream {
+    NSLog(@"Request stream closed");
+}
+
+
+#pragma mark - PTDiffusionJSONRequestDelegate
+
+- (void)diffusionTopicTreeRegistration:(PTDiffusionTopicTreeRegistration *const)registration
+             didReceiveRequestWithJSON:(PTDiffusionJSON *const)json
+                               context:(PTDiffusionRequestContext *const)context
+                             responder:(PTDiffusionResponder *const)responder {
+    [self dispatchRequestWithJSON:json context:context responder:responder];
+}
+
+
+- (void)diffusionTopicTreeRegistrationDidClose:(PTDiffusionTopicTreeRegistration *const)registration {
+    NSLog(@"Request handler closed");
+}
+
+
+- (void)diffusionTopicTreeRegistration:(PTDiffusionTopicTreeRegistration *const)registration
+                      didFailWithError:(NSError *const)error {
+    NSLog(@"Request handler failed: %@", error);
+}
+
+@end
@@ -0,0 +1,70 @@
+//
+//  ConflatingStreamDelegate.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Stands in for the delegate of a value stream, keeping only the latest pending
+ update for each topic and passing updates on no more often than
+ maximumDeliveryRate, so that a delegate slower than the topics it follows is
+ never handed a backlog.
+
+ The stream's delegate is fixed when it is created, so conflation is chosen by
+ creating the stream with this in place of the real delegate and then adding it
+ with PTDiffusionTopicsFeature#addStream:withSelector: as usual:
+
+     conflater = [[ConflatingStreamDelegate alloc] initWithDelegate:self maximumDeliveryRate:60.0];
+     stream = [PTDiffusionJSON valueStreamWithDelegate:(id)conflater];
+
+ Any of the value stream delegate protocols can be stood in for. An update
+ passed on after others were dropped carries the old value of the first and
+ the new value of the last, as though the delegate had seen one change. An
+ update arriving after a quiet period is passed on at once; the rest wait for
+ the next delivery, when every pending topic is delivered in the order it first
+ became pending. Subscription notifications for a topic, and failure and close
+ notifications, are passed on after any pending updates they follow. Time
+ series event streams are passed through unconflated, as events are not
+ values to be superseded.
+
+ Neither the delegate nor the receiver is retained by the stream, so the
+ caller must keep the receiver. Instances are confined to the main queue.
+ */
+@interface ConflatingStreamDelegate : NSProxy
+
+- (instancetype)initWithDelegate:(id<PTDiffusionStreamDelegate>)delegate
+             maximumDeliveryRate:(double)maximumDeliveryRate;
+
+@property (nonatomic, readonly, weak) id<PTDiffusionStreamDelegate> delegate;
+
+/**
+ Deliveries per second.
+ */
+@property (nonatomic, readonly) double maximumDeliveryRate;
+
+/**
+ Updates received from the stream.
+ */
+@property (nonatomic, readonly) NSUInteger receivedCount;
+
+/**
+ Updates passed on to the delegate. The difference from receivedCount is the
+ number dropped, less any still pending.
+ */
+@property (nonatomic, readonly) NSUInteger deliveredCount;
+
+/**
+ Delivers every pending update now.
+ */
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
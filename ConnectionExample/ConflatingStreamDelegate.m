@@ -0,0 +1,164 @@
+//
+//  ConflatingStreamDelegate.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ConflatingStreamDelegate.h"
+
+
+// Every value stream delegate protocol's update method has this prefix and
+// takes the stream, path, specification, old value and new value.
+static NSString *const _UpdateSelectorPrefix = @"diffusionStream:didUpdateTopicPath:specification:";
+static const NSUInteger _TopicPathArgument = 3;
+static const NSUInteger _SpecificationArgument = 4;
+static const NSUInteger _NewValueArgument = 6;
+
+
+@implementation ConflatingStreamDelegate {
+    uint64_t _minimumIntervalNanoseconds;
+    uint64_t _lastDeliveryTime;
+    BOOL _deliveryScheduled;
+    // Topic paths in the order they became pending.
+    NSMutableOrderedSet<NSString *> *_pendingTopicPaths;
+    NSMutableDictionary<NSString *, NSInvocation *> *_pendingUpdates;
+}
+
+
+- (instancetype)initWithDelegate:(id<PTDiffusionStreamDelegate> const)delegate
+             maximumDeliveryRate:(const double)maximumDeliveryRate {
+    if (!(maximumDeliveryRate > 0)) {
+        [NSException raise:NSInvalidArgumentException format:@"Maximum delivery rate must be positive"];
+    }
+    _delegate = delegate;
+    _maximumDeliveryRate = maximumDeliveryRate;
+    _minimumIntervalNanoseconds = (uint64_t)(NSEC_PER_SEC / maximumDeliveryRate);
+    _pendingTopicPaths = [NSMutableOrderedSet new];
+    _pendingUpdates = [NSMutableDictionary new];
+    return self;
+}
+
+
+- (BOOL)respondsToSelector:(const SEL)selector {
+    return [_delegate respondsToSelector:selector];
+}
+
+
+- (BOOL)conformsToProtocol:(Protocol *const)protocol {
+    return [_delegate conformsToProtocol:protocol];
+}
+
+
+- (NSMethodSignature *)methodSignatureForSelector:(const SEL)selector {
+    NSMethodSignature *const signature = [(NSObject *)_delegate methodSignatureForSelector:selector];
+    // Once the delegate has gone, messages are accepted and dropped.
+    return signature ?: [NSMethodSignature signatureWithObjCTypes:"v@:"];
+}
+
+
+- (void)forwardInvocation:(NSInvocation *const)invocation {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    const id delegate = _delegate;
+    if (!delegate) {
+        return;
+    }
+
+    const SEL selector = invocation.selector;
+    if (7 == invocation.methodSignature.numberOfArguments &&
+        [NSStringFromSelector(selector) hasPrefix:_UpdateSelectorPrefix]) {
+        [self conflateUpdate:invocation];
+        return;
+    }
+
+    if (selector == @selector(diffusionStream:didSubscribeToTopicPath:specification:) ||
+        selector == @selector(diffusionStream:didUnsubscribeFromTopicPath:specification:reason:)) {
+        __unsafe_unretained NSString *topicPath = nil;
+        [invocation getArgument:&topicPath atIndex:_TopicPathArgument];
+        [self deliverUpdateForTopicPath:topicPath];
+    } else {
+        [self flush];
+    }
+    [invocation invokeWithTarget:delegate];
+}
+
+
+- (void)conflateUpdate:(NSInvocation *const)invocation {
+    ++_receivedCount;
+    __unsafe_unretained NSString *topicPath = nil;
+    [invocation getArgument:&topicPath atIndex:_TopicPathArgument];
+
+    NSInvocation *const pending = _pendingUpdates[topicPath];
+    if (pending) {
+        // Keep the old value of the pending update, which is what the delegate
+        // last saw, and take everything else from the latest.
+        __unsafe_unretained id argument = nil;
+        [invocation getArgument:&argument atIndex:_SpecificationArgument];
+        [pending setArgument:&argument atIndex:_SpecificationArgument];
+        [invocation getArgument:&argument atIndex:_NewValueArgument];
+        [pending setArgument:&argument atIndex:_NewValueArgument];
+        return;
+    }
+
+    [invocation retainArguments];
+    _pendingUpdates[topicPath] = invocation;
+    [_pendingTopicPaths addObject:topicPath];
+    [self scheduleDelivery];
+}
+
+
+- (void)scheduleDelivery {
+    if (_deliveryScheduled) {
+        return;
+    }
+    const uint64_t elapsed = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - _lastDeliveryTime;
+    if (elapsed >= _minimumIntervalNanoseconds) {
+        [self flush];
+        return;
+    }
+    _deliveryScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_minimumIntervalNanoseconds - elapsed)),
+                   dispatch_get_main_queue(), ^{
+        self->_deliveryScheduled = NO;
+        [self flush];
+    });
+}
+
+
+- (void)deliverUpdateForTopicPath:(NSString *const)topicPath {
+    NSInvocation *const pending = _pendingUpdates[topicPath];
+    const id delegate = _delegate;
+    if (!pending || !delegate) {
+        return;
+    }
+    [_pendingUpdates removeObjectForKey:topicPath];
+    [_pendingTopicPaths removeObject:topicPath];
+    ++_deliveredCount;
+    [pending invokeWithTarget:delegate];
+}
+
+
+- (void)flush {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    _lastDeliveryTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    if (0 == _pendingTopicPaths.count) {
+        return;
+    }
+    // Swapped out first, so updates the delegate causes to arrive are held
+    // for the next delivery.
+    NSOrderedSet<NSString *> *const topicPaths = _pendingTopicPaths;
+    NSDictionary<NSString *, NSInvocation *> *const updates = _pendingUpdates;
+    _pendingTopicPaths = [NSMutableOrderedSet new];
+    _pendingUpdates = [NSMutableDictionary new];
+
+    const id delegate = _delegate;
+    if (!delegate) {
+        return;
+    }
+    for (NSString *const topicPath in topicPaths) {
+        ++_deliveredCount;
+        [updates[topicPath] invokeWithTarget:delegate];
+    }
+}
+
+@end
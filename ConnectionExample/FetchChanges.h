@@ -0,0 +1,84 @@
+//
+//  FetchChanges.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Opaque record of a previous fetch, holding a 64-bit digest of the type and
+ value of every topic it saw. Pass it to the next fetch to get only what has
+ changed. Instances are immutable and can be shared between threads.
+ */
+@interface FetchSnapshotToken : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The number of topics the snapshot covers.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+
+/**
+ The difference between a JSON fetch and a previous snapshot of the same
+ selection.
+ */
+@interface FetchChanges : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Pages through a JSON fetch and compares every topic against the given token.
+ Values are digested on a background queue and only topics that are new or
+ whose type or value differ are retained, so the memory and work handed to the
+ caller are proportional to the amount of change.
+
+ The selection and range of the request should be the same for every fetch
+ sharing a chain of tokens; topics outside the range are reported as removed.
+
+ Must be called on the main queue; the completion handler is called on the
+ main queue.
+
+ @param token The token from a previous fetch, or `nil` to report every topic
+ as added.
+ */
++ (void)fetchWithRequest:(PTDiffusionFetchRequest *)request
+ topicSelectorExpression:(NSString *)expression
+                   since:(nullable FetchSnapshotToken *)token
+                pageSize:(UInt32)pageSize
+       completionHandler:(void (^)(FetchChanges * _Nullable changes, NSError * _Nullable error))completionHandler;
+
+/**
+ Topics not present in the previous snapshot, in path order.
+ */
+@property (nonatomic, readonly) NSArray<PTDiffusionJSONFetchTopicResult *> *added;
+
+/**
+ Topics whose type or value changed since the previous snapshot, in path order.
+ */
+@property (nonatomic, readonly) NSArray<PTDiffusionJSONFetchTopicResult *> *changed;
+
+/**
+ Paths of topics in the previous snapshot that are no longer selected.
+ */
+@property (nonatomic, readonly) NSArray<NSString *> *removed;
+
+/**
+ The token to pass to the next fetch.
+ */
+@property (nonatomic, readonly) FetchSnapshotToken *token;
+
+@end
+
+NS_ASSUME_NONNULL_END
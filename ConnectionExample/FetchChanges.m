@@ -0,0 +1,160 @@
+//
+//  FetchChanges.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "FetchChanges.h"
+#import "FetchStream.h"
+
+
+static uint64_t _FNV1a(uint64_t hash, const uint8_t *const bytes, const NSUInteger length) {
+    for (NSUInteger i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+static uint64_t _Digest(PTDiffusionJSONFetchTopicResult *const result) {
+    const uint64_t type = (uint64_t)result.specification.type;
+    uint64_t hash = _FNV1a(14695981039346656037ULL, (const uint8_t *)&type, sizeof(type));
+    NSData *const data = result.json.data;
+    if (data) {
+        // Distinguish a topic without a value from one with an empty value.
+        const uint8_t present = 1;
+        hash = _FNV1a(hash, &present, sizeof(present));
+        hash = _FNV1a(hash, data.bytes, data.length);
+    }
+    return hash;
+}
+
+
+@interface FetchSnapshotToken ()
+
+@property (nonatomic, readonly) NSDictionary<NSString *, NSNumber *> *digests;
+
+- (instancetype)initWithDigests:(NSDictionary<NSString *, NSNumber *> *)digests NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@implementation FetchSnapshotToken
+
+- (instancetype)initWithDigests:(NSDictionary<NSString *, NSNumber *> *const)digests {
+    if ((self = [super init])) {
+        _digests = digests;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _digests.count;
+}
+
+@end
+
+
+@interface FetchChanges () <FetchStreamDelegate>
+
+@property (nonatomic, copy) void (^completionHandler)(FetchChanges * _Nullable changes, NSError * _Nullable error);
+
+@end
+
+@implementation FetchChanges {
+    NSDictionary<NSString *, NSNumber *> *_previous;
+    NSMutableDictionary<NSString *, NSNumber *> *_current;
+    NSMutableArray<PTDiffusionJSONFetchTopicResult *> *_added;
+    NSMutableArray<PTDiffusionJSONFetchTopicResult *> *_changed;
+}
+
+
++ (void)fetchWithRequest:(PTDiffusionFetchRequest *const)request
+ topicSelectorExpression:(NSString *const)expression
+                   since:(FetchSnapshotToken *const)token
+                pageSize:(const UInt32)pageSize
+       completionHandler:(void (^const)(FetchChanges *, NSError *))completionHandler {
+    FetchChanges *const changes = [[FetchChanges alloc] initWithPrevious:token.digests ?: @{}];
+    changes.completionHandler = completionHandler;
+
+    FetchStream *const stream =
+        [[FetchStream alloc] initWithRequest:request
+                                    pageSize:pageSize
+                                 pageFetcher:[FetchStream jsonPageFetcherWithTopicSelectorExpression:expression]
+                                    delegate:changes];
+    stream.delegateQueue = dispatch_queue_create("FetchChanges.digest", DISPATCH_QUEUE_SERIAL);
+    [stream start];
+}
+
+
+- (instancetype)initWithPrevious:(NSDictionary<NSString *, NSNumber *> *const)previous {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _previous = previous;
+    _current = [NSMutableDictionary dictionaryWithCapacity:previous.count];
+    _added = [NSMutableArray new];
+    _changed = [NSMutableArray new];
+    return self;
+}
+
+
+- (NSArray<PTDiffusionJSONFetchTopicResult *> *)added {
+    return _added;
+}
+
+
+- (NSArray<PTDiffusionJSONFetchTopicResult *> *)changed {
+    return _changed;
+}
+
+
+- (void)fetchStream:(FetchStream *const)stream didFetchTopicResult:(PTDiffusionFetchTopicResult *const)result {
+    if (![result isKindOfClass:[PTDiffusionJSONFetchTopicResult class]]) {
+        return;
+    }
+    PTDiffusionJSONFetchTopicResult *const jsonResult = (PTDiffusionJSONFetchTopicResult *)result;
+    NSNumber *const digest = @(_Digest(jsonResult));
+    NSString *const path = jsonResult.path;
+    _current[path] = digest;
+
+    NSNumber *const previousDigest = _previous[path];
+    if (!previousDigest) {
+        [_added addObject:jsonResult];
+    } else if (![previousDigest isEqualToNumber:digest]) {
+        [_changed addObject:jsonResult];
+    }
+}
+
+
+- (void)fetchStreamDidComplete:(FetchStream *const)stream {
+    NSMutableArray<NSString *> *const removed = [NSMutableArray new];
+    for (NSString *const path in _previous) {
+        if (!_current[path]) {
+            [removed addObject:path];
+        }
+    }
+    [removed sortUsingSelector:@selector(compare:)];
+    _removed = removed;
+    _token = [[FetchSnapshotToken alloc] initWithDigests:[_current copy]];
+    _previous = nil;
+    _current = nil;
+
+    void (^const completionHandler)(FetchChanges *, NSError *) = _completionHandler;
+    _completionHandler = nil;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(self, nil);
+    });
+}
+
+
+- (void)fetchStream:(FetchStream *const)stream didFailWithError:(NSError *const)error {
+    void (^const completionHandler)(FetchChanges *, NSError *) = _completionHandler;
+    _completionHandler = nil;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        completionHandler(nil, error);
+    });
+}
+
+@end
@@ -0,0 +1,113 @@
+//
+//  FetchStream.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+@class FetchStream;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Issues one page of a fetch. Implementations call the completion handler with
+ the result of sending the given request with one of the (typed) fetch methods
+ of PTDiffusionFetchRequest.
+ */
+typedef void (^FetchStreamPageFetcher)(PTDiffusionFetchRequest *request,
+    void (^completionHandler)(PTDiffusionFetchResult * _Nullable result, NSError * _Nullable error));
+
+@protocol FetchStreamDelegate <NSObject>
+
+/**
+ Called once for each topic selected by the fetch, in path order.
+ */
+- (void)fetchStream:(FetchStream *)stream didFetchTopicResult:(PTDiffusionFetchTopicResult *)result;
+
+/**
+ Called once after the last result has been delivered.
+ */
+- (void)fetchStreamDidComplete:(FetchStream *)stream;
+
+/**
+ Called if fetching a page fails. No further messages are sent to the delegate.
+ */
+- (void)fetchStream:(FetchStream *)stream didFailWithError:(NSError *)error;
+
+@end
+
+/**
+ Walks the results of a fetch page by page, using PTDiffusionFetchRequest#first:
+ and PTDiffusionFetchRequest#afterTopicPath:, and delivers them to a delegate
+ one topic at a time.
+
+ The request for the next page is sent as soon as the current page arrives, so
+ the server is working on it while the delegate consumes the current one. At
+ most maximumBufferedPages pages are held by the stream at any time, including
+ the page being delivered, so memory use depends on the page size and not on
+ the size of the topic tree. The pipelining is done by a PagePipeline.
+ */
+@interface FetchStream : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @param request The request to page through. Range constraints set with
+ PTDiffusionFetchRequest#toTopicPath: or PTDiffusionFetchRequest#beforeTopicPath:
+ are honoured; the start point and page size are set by the stream.
+ @param pageSize The maximum number of results requested for each page.
+ @param pageFetcher Issues each page; see pageFetcherWithTopicSelectorExpression:
+ @param delegate Receives the results. Held strongly until the stream completes,
+ fails or is cancelled.
+ */
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *)request
+                       pageSize:(UInt32)pageSize
+                    pageFetcher:(FetchStreamPageFetcher)pageFetcher
+                       delegate:(id<FetchStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+/**
+ A page fetcher for PTDiffusionFetchRequest#fetchWithTopicSelectorExpression:completionHandler:
+ */
++ (FetchStreamPageFetcher)pageFetcherWithTopicSelectorExpression:(NSString *)expression;
+
+/**
+ A page fetcher for PTDiffusionFetchRequest#fetchJSONValuesWithTopicSelectorExpression:completionHandler:
+ */
++ (FetchStreamPageFetcher)jsonPageFetcherWithTopicSelectorExpression:(NSString *)expression;
+
+/**
+ The maximum number of pages held at once. Defaults to 2 and must be at least 1;
+ a value of 1 disables pipelining.
+ */
+@property (nonatomic) NSUInteger maximumBufferedPages;
+
+/**
+ The serial queue on which the delegate is sent messages. Defaults to the main
+ queue.
+ */
+@property (nonatomic) dispatch_queue_t delegateQueue;
+
+/**
+ The number of results delivered so far.
+ */
+@property (atomic, readonly) NSUInteger resultCount;
+
+/**
+ Sends the first page request. Must be called on the main queue, once.
+ */
+- (void)start;
+
+/**
+ Stops the stream. The delegate is sent no further messages after the result
+ currently being delivered, if any.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
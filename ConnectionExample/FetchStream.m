@@ -0,0 +1,126 @@
+//
+//  FetchStream.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "FetchStream.h"
+#import "PagePipeline.h"
+
+
+@interface FetchStream ()
+
+@property (atomic) BOOL cancelled;
+@property (atomic, nullable) PagePipeline *pipeline;
+@property (atomic, readwrite) NSUInteger resultCount;
+
+@end
+
+@implementation FetchStream {
+    // All state below is confined to the main queue, which is where the
+    // Diffusion client calls fetch completion handlers.
+    PTDiffusionFetchRequest *_pageRequest;
+    FetchStreamPageFetcher _pageFetcher;
+    id<FetchStreamDelegate> _delegate;
+    NSString *_lastPath;
+}
+
+
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *const)request
+                       pageSize:(const UInt32)pageSize
+                    pageFetcher:(const FetchStreamPageFetcher)pageFetcher
+                       delegate:(const id<FetchStreamDelegate>)delegate {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    if (0 == pageSize) {
+        [NSException raise:NSInvalidArgumentException format:@"Page size must be greater than zero"];
+    }
+    _pageRequest = [request first:pageSize];
+    _pageFetcher = [pageFetcher copy];
+    _delegate = delegate;
+    _maximumBufferedPages = 2;
+    _delegateQueue = dispatch_get_main_queue();
+    return self;
+}
+
+
++ (FetchStreamPageFetcher)pageFetcherWithTopicSelectorExpression:(NSString *const)expression {
+    NSString *const selector = [expression copy];
+    return ^(PTDiffusionFetchRequest *const request, void (^const completionHandler)(PTDiffusionFetchResult *, NSError *)) {
+        [request fetchWithTopicSelectorExpression:selector completionHandler:completionHandler];
+    };
+}
+
+
++ (FetchStreamPageFetcher)jsonPageFetcherWithTopicSelectorExpression:(NSString *const)expression {
+    NSString *const selector = [expression copy];
+    return ^(PTDiffusionFetchRequest *const request, void (^const completionHandler)(PTDiffusionFetchResult *, NSError *)) {
+        [request fetchJSONValuesWithTopicSelectorExpression:selector completionHandler:completionHandler];
+    };
+}
+
+
+- (void)setMaximumBufferedPages:(const NSUInteger)maximumBufferedPages {
+    if (0 == maximumBufferedPages) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one page must be buffered"];
+    }
+    _maximumBufferedPages = maximumBufferedPages;
+}
+
+
+- (void)start {
+    NSAssert(NSThread.isMainThread, @"Streams must be started on the main queue");
+    if (self.pipeline) {
+        [NSException raise:NSInternalInconsistencyException format:@"Stream already started"];
+    }
+    // The pipeline holds the delegate from here on.
+    id<FetchStreamDelegate> const delegate = _delegate;
+    _delegate = nil;
+    PagePipeline *const pipeline = [[PagePipeline alloc] initWithPageRequester:^(const PagePipelinePageHandler pageHandler) {
+        [self fetchNextPageWithHandler:pageHandler];
+    } itemHandler:^(PTDiffusionFetchTopicResult *const result) {
+        [delegate fetchStream:self didFetchTopicResult:result];
+        self.resultCount++;
+    } completionHandler:^{
+        [delegate fetchStreamDidComplete:self];
+    } failureHandler:^(NSError *const error) {
+        [delegate fetchStream:self didFailWithError:error];
+    }];
+    pipeline.maximumBufferedPages = _maximumBufferedPages;
+    pipeline.delegateQueue = _delegateQueue;
+    self.pipeline = pipeline;
+    if (self.cancelled) {
+        [pipeline cancel];
+    }
+    [pipeline start];
+}
+
+
+- (void)cancel {
+    self.cancelled = YES;
+    [self.pipeline cancel];
+}
+
+
+- (void)fetchNextPageWithHandler:(const PagePipelinePageHandler)pageHandler {
+    PTDiffusionFetchRequest *const request =
+        _lastPath ? [_pageRequest afterTopicPath:_lastPath] : _pageRequest;
+    _pageFetcher(request, ^(PTDiffusionFetchResult *const result, NSError *const error) {
+        if (!result) {
+            pageHandler(nil, NO, error);
+            return;
+        }
+        NSArray<PTDiffusionFetchTopicResult *> *const results = result.results;
+        // An empty page can only be reported as having more if a single result
+        // would exceed maximumResultSize, so stop rather than spin.
+        const BOOL more = result.hasMore && results.count > 0;
+        if (more) {
+            self->_lastPath = results.lastObject.path;
+        }
+        pageHandler(results, more, nil);
+    });
+}
+
+@end
@@ -0,0 +1,63 @@
+//
+//  PTDiffusionMutableRecordV2Model+RecordV2Delta.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "RecordV2Accessor.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString *const RecordV2DeltaErrorDomain;
+
+typedef NS_ENUM(NSInteger, RecordV2DeltaErrorCode) {
+    /** The new value does not have a field the changes refer to. */
+    RecordV2DeltaErrorCode_MissingField = 1,
+    /** A change names a record the schema does not define. */
+    RecordV2DeltaErrorCode_UnknownRecord,
+};
+
+/**
+ Applies RecordV2 deltas to a mutable model in place, so that a consumer of a
+ record value stream can keep one model current and update only what the
+ delta touches.
+ */
+@interface PTDiffusionMutableRecordV2Model (RecordV2Delta)
+
+/**
+ Applies changes computed against the receiver's current value.
+
+ A delta records where values changed but not what they changed to, so the new
+ values are read from `record` through `accessor`, which must be for the
+ receiver's schema. Structural changes (fields or records added or removed)
+ are rare and decode the affected part of `record` in full.
+
+ @param changes The changes from PTDiffusionRecordV2Delta#changesWithSchema:error:
+ @param record The value the changes lead to.
+ @return The handles of every field changed, added or removed, packed as an
+ array of RecordV2FieldHandle; or `nil` if the changes could not be applied,
+ in which case the model may be partially updated. Changes that `record` does
+ not match are reported in RecordV2DeltaErrorDomain.
+ */
+- (nullable NSData *)applyChanges:(NSArray<PTDiffusionRecordV2DeltaChange *> *)changes
+                       fromRecord:(PTDiffusionRecordV2 *)record
+                         accessor:(RecordV2Accessor *)accessor
+                            error:(NSError **)error;
+
+/**
+ Computes the delta between two values, as received by
+ PTDiffusionRecordV2ValueStreamDelegate, and applies it. The receiver must
+ currently hold `oldRecord`.
+ */
+- (nullable NSData *)applyDeltaFromRecord:(PTDiffusionRecordV2 *)oldRecord
+                                 toRecord:(PTDiffusionRecordV2 *)newRecord
+                                 accessor:(RecordV2Accessor *)accessor
+                                    error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
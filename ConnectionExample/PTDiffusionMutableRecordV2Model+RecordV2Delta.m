@@ -0,0 +1,249 @@
+//
+//  PTDiffusionMutableRecordV2Model+RecordV2Delta.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "PTDiffusionMutableRecordV2Model+RecordV2Delta.h"
+
+
+NSString *const RecordV2DeltaErrorDomain = @"RecordV2DeltaErrorDomain";
+
+
+static void _SetError(NSError **const error, const RecordV2DeltaErrorCode code, NSString *const description) {
+    if (error) {
+        *error = [NSError errorWithDomain:RecordV2DeltaErrorDomain
+                                     code:code
+                                 userInfo:@{NSLocalizedDescriptionKey: description}];
+    }
+}
+
+
+static PTDiffusionRecordV2SchemaRecord *_RecordNamed(PTDiffusionRecordV2Schema *const schema,
+                                                     NSString *const name,
+                                                     NSError **const error) {
+    for (PTDiffusionRecordV2SchemaRecord *const record in schema.records) {
+        if ([record.name isEqualToString:name]) {
+            return record;
+        }
+    }
+    _SetError(error, RecordV2DeltaErrorCode_UnknownRecord, [NSString stringWithFormat:@"No record named %@", name]);
+    return nil;
+}
+
+
+@implementation PTDiffusionMutableRecordV2Model (RecordV2Delta)
+
+
+- (NSData *)applyDeltaFromRecord:(PTDiffusionRecordV2 *const)oldRecord
+                        toRecord:(PTDiffusionRecordV2 *const)newRecord
+                        accessor:(RecordV2Accessor *const)accessor
+                           error:(NSError **const)error {
+    NSArray<PTDiffusionRecordV2DeltaChange *> *const changes =
+        [[newRecord diffFromOriginalRecord:oldRecord] changesWithSchema:accessor.schema error:error];
+    if (!changes) {
+        return nil;
+    }
+    return [self applyChanges:changes fromRecord:newRecord accessor:accessor error:error];
+}
+
+
+- (NSData *)applyChanges:(NSArray<PTDiffusionRecordV2DeltaChange *> *const)changes
+              fromRecord:(PTDiffusionRecordV2 *const)record
+                accessor:(RecordV2Accessor *const)accessor
+                   error:(NSError **const)error {
+    NSMutableData *const changed = [NSMutableData new];
+    NSArray<NSArray<NSString *> *> *values = nil;
+
+    for (PTDiffusionRecordV2DeltaChange *const change in changes) {
+        PTDiffusionRecordV2DeltaChangeType *const type = change.type;
+        NSString *const recordName = change.recordName;
+        const SInt32 recordIndex = change.recordIndex;
+
+        if ([type isEqual:PTDiffusionRecordV2DeltaChangeType.fieldChanged]) {
+            // The common case: read the one value straight from the bytes.
+            const RecordV2FieldHandle handle = [accessor handleForRecordName:recordName
+                                                                  recordIndex:recordIndex
+                                                                    fieldName:change.fieldName
+                                                                   fieldIndex:change.fieldIndex];
+            NSString *const value = [accessor stringForField:handle ofRecord:record];
+            if (!value) {
+                _SetError(error, RecordV2DeltaErrorCode_MissingField, [NSString stringWithFormat:@"Record has no field %@", change.key]);
+                return nil;
+            }
+            NSNumber *const fieldCount = [self fieldCountWithRecordName:recordName
+                                                            recordIndex:recordIndex
+                                                              fieldName:change.fieldName
+                                                                  error:error];
+            if (!fieldCount) {
+                return nil;
+            }
+            // A field changed just past the end of a variable field list is new.
+            if (change.fieldIndex == fieldCount.intValue) {
+                if (![self addToRecordName:recordName recordIndex:recordIndex fieldValues:@[value] error:error]) {
+                    return nil;
+                }
+            } else if (![self setRecordName:recordName
+                                recordIndex:recordIndex
+                                  fieldName:change.fieldName
+                                 fieldIndex:change.fieldIndex
+                               toFieldValue:value
+                                      error:error]) {
+                return nil;
+            }
+            [changed appendBytes:&handle length:sizeof(handle)];
+            continue;
+        }
+
+        if (!values && !(values = [record recordsWithError:error])) {
+            return nil;
+        }
+        PTDiffusionRecordV2SchemaRecord *const recordDefinition = _RecordNamed(accessor.schema, recordName, error);
+        if (!recordDefinition) {
+            return nil;
+        }
+
+        if ([type isEqual:PTDiffusionRecordV2DeltaChangeType.fieldsAdded]) {
+            const RecordV2FieldHandle first = [accessor handleForRecordName:recordName
+                                                                 recordIndex:recordIndex
+                                                                   fieldName:change.fieldName
+                                                                  fieldIndex:change.fieldIndex];
+            NSArray<NSString *> *const fields = first.record < values.count ? values[first.record] : nil;
+            if (!fields || first.field > fields.count) {
+                _SetError(error, RecordV2DeltaErrorCode_MissingField, [NSString stringWithFormat:@"Record has no field %@", change.key]);
+                return nil;
+            }
+            NSArray<NSString *> *const added =
+                [fields subarrayWithRange:NSMakeRange(first.field, fields.count - first.field)];
+            if (![self addToRecordName:recordName recordIndex:recordIndex fieldValues:added error:error]) {
+                return nil;
+            }
+            [self appendHandlesOfRecordName:recordName
+                                recordIndex:recordIndex
+                                  fieldName:change.fieldName
+                                  fromIndex:change.fieldIndex
+                                   accessor:accessor
+                                     toData:changed];
+        } else if ([type isEqual:PTDiffusionRecordV2DeltaChangeType.fieldsRemoved]) {
+            const NSUInteger before = changed.length;
+            [self appendHandlesOfRecordName:recordName
+                                recordIndex:recordIndex
+                                  fieldName:change.fieldName
+                                  fromIndex:change.fieldIndex
+                                   accessor:accessor
+                                     toData:changed];
+            const NSUInteger removed = (changed.length - before) / sizeof(RecordV2FieldHandle);
+            // Remove from the end so the remaining indexes stay valid.
+            for (NSUInteger i = removed; i > 0; --i) {
+                if (![self removeFieldWithIndex:change.fieldIndex + (SInt32)i - 1
+                                 fromRecordName:recordName
+                                    recordIndex:recordIndex
+                                          error:error]) {
+                    return nil;
+                }
+            }
+        } else if ([type isEqual:PTDiffusionRecordV2DeltaChangeType.recordsAdded]) {
+            const RecordV2FieldHandle first = [accessor handleForRecordName:recordName
+                                                                 recordIndex:recordIndex
+                                                                   fieldName:recordDefinition.fields.firstObject.name
+                                                                  fieldIndex:0];
+            for (NSUInteger position = first.record; position < values.count; ++position) {
+                const SInt32 index = recordIndex + (SInt32)(position - first.record);
+                if (![self addRecordError:error] ||
+                    ![self setFieldValues:values[position]
+                             ofRecordName:recordName
+                              recordIndex:index
+                               definition:recordDefinition
+                                    error:error]) {
+                    return nil;
+                }
+                [self appendHandlesOfRecordName:recordName recordIndex:index definition:recordDefinition accessor:accessor toData:changed];
+            }
+        } else if ([type isEqual:PTDiffusionRecordV2DeltaChangeType.recordsRemoved]) {
+            NSNumber *const count = [self recordCountWithRecordName:recordName error:error];
+            if (!count) {
+                return nil;
+            }
+            for (SInt32 index = count.intValue - 1; index >= recordIndex; --index) {
+                [self appendHandlesOfRecordName:recordName recordIndex:index definition:recordDefinition accessor:accessor toData:changed];
+                if (![self removeRecordWithIndex:index error:error]) {
+                    return nil;
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+
+/**
+ Sets every field of a newly added record occurrence, appending to its
+ variable field list beyond the minimum the model starts with.
+ */
+- (BOOL)setFieldValues:(NSArray<NSString *> *const)fieldValues
+          ofRecordName:(NSString *const)recordName
+           recordIndex:(const SInt32)recordIndex
+            definition:(PTDiffusionRecordV2SchemaRecord *const)definition
+                 error:(NSError **const)error {
+    NSUInteger position = 0;
+    for (PTDiffusionRecordV2SchemaField *const field in definition.fields) {
+        const BOOL last = field == definition.fields.lastObject;
+        const NSUInteger occurrences = last ? fieldValues.count - MIN(position, fieldValues.count) : (NSUInteger)field.max;
+        for (SInt32 fieldIndex = 0; fieldIndex < (SInt32)occurrences && position < fieldValues.count; ++fieldIndex, ++position) {
+            if (fieldIndex >= field.min && field.isVariable) {
+                NSArray<NSString *> *const rest =
+                    [fieldValues subarrayWithRange:NSMakeRange(position, fieldValues.count - position)];
+                return [self addToRecordName:recordName recordIndex:recordIndex fieldValues:rest error:error];
+            }
+            if (![self setRecordName:recordName
+                         recordIndex:recordIndex
+                           fieldName:field.name
+                          fieldIndex:fieldIndex
+                        toFieldValue:fieldValues[position]
+                               error:error]) {
+                return NO;
+            }
+        }
+    }
+    return YES;
+}
+
+
+/**
+ Appends the handles of the occurrences of a field from an index to the end
+ of its current list.
+ */
+- (void)appendHandlesOfRecordName:(NSString *const)recordName
+                      recordIndex:(const SInt32)recordIndex
+                        fieldName:(NSString *const)fieldName
+                        fromIndex:(const SInt32)fromIndex
+                         accessor:(RecordV2Accessor *const)accessor
+                           toData:(NSMutableData *const)data {
+    NSNumber *const count = [self fieldCountWithRecordName:recordName recordIndex:recordIndex fieldName:fieldName error:NULL];
+    for (SInt32 fieldIndex = fromIndex; fieldIndex < count.intValue; ++fieldIndex) {
+        const RecordV2FieldHandle handle = [accessor handleForRecordName:recordName
+                                                              recordIndex:recordIndex
+                                                                fieldName:fieldName
+                                                               fieldIndex:fieldIndex];
+        [data appendBytes:&handle length:sizeof(handle)];
+    }
+}
+
+
+- (void)appendHandlesOfRecordName:(NSString *const)recordName
+                      recordIndex:(const SInt32)recordIndex
+                       definition:(PTDiffusionRecordV2SchemaRecord *const)definition
+                         accessor:(RecordV2Accessor *const)accessor
+                           toData:(NSMutableData *const)data {
+    for (PTDiffusionRecordV2SchemaField *const field in definition.fields) {
+        [self appendHandlesOfRecordName:recordName
+                            recordIndex:recordIndex
+                              fieldName:field.name
+                              fromIndex:0
+                               accessor:accessor
+                                 toData:data];
+    }
+}
+
+@end
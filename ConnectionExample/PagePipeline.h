@@ -0,0 +1,79 @@
+//
+//  PagePipeline.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Called with the items of one page. more is NO for the last page. items is nil
+ if the page could not be obtained, in which case error describes why.
+ */
+typedef void (^PagePipelinePageHandler)(NSArray * _Nullable items, BOOL more, NSError * _Nullable error);
+
+/**
+ Requests the next page and calls the page handler with it, once, on the main
+ queue.
+ */
+typedef void (^PagePipelinePageRequester)(PagePipelinePageHandler pageHandler);
+
+/**
+ Requests pages one after another and delivers their items one at a time on a
+ delegate queue. This is the paging machinery shared by FetchStream and
+ TimeSeriesQueryStream.
+
+ The request for the next page is sent as soon as the current page arrives, so
+ the server is working on it while the current one is consumed. At most
+ maximumBufferedPages pages are held at any time, including the page being
+ delivered.
+
+ The handlers are released once the pipeline completes, fails or is cancelled.
+ */
+@interface PagePipeline : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @param pageRequester Called on the main queue, never while a page is in flight.
+ @param itemHandler Called on the delegate queue for each item, in page order.
+ @param completionHandler Called on the delegate queue after the last item.
+ @param failureHandler Called on the delegate queue if a page cannot be obtained.
+ */
+- (instancetype)initWithPageRequester:(PagePipelinePageRequester)pageRequester
+                          itemHandler:(void (^)(id item))itemHandler
+                    completionHandler:(dispatch_block_t)completionHandler
+                       failureHandler:(void (^)(NSError *error))failureHandler NS_DESIGNATED_INITIALIZER;
+
+/**
+ The maximum number of pages held at once. Defaults to 2 and must be at least 1;
+ a value of 1 disables pipelining.
+ */
+@property (nonatomic) NSUInteger maximumBufferedPages;
+
+/**
+ The serial queue on which the item, completion and failure handlers are
+ called. Defaults to the main queue.
+ */
+@property (nonatomic) dispatch_queue_t delegateQueue;
+
+@property (atomic, readonly) BOOL cancelled;
+
+/**
+ Requests the first page. Must be called on the main queue, once.
+ */
+- (void)start;
+
+/**
+ Stops the pipeline. No handler is called after the item currently being
+ delivered, if any.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
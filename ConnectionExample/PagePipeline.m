@@ -0,0 +1,159 @@
+//
+//  PagePipeline.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "PagePipeline.h"
+
+
+@interface PagePipeline ()
+
+@property (atomic, readwrite) BOOL cancelled;
+
+@end
+
+@implementation PagePipeline {
+    // All state below is confined to the main queue, which is where the
+    // Diffusion client calls completion handlers.
+    PagePipelinePageRequester _pageRequester;
+    void (^_itemHandler)(id);
+    dispatch_block_t _completionHandler;
+    void (^_failureHandler)(NSError *);
+    BOOL _started;
+    BOOL _inFlight;
+    BOOL _exhausted;
+    NSUInteger _heldPages;
+}
+
+
+- (instancetype)initWithPageRequester:(const PagePipelinePageRequester)pageRequester
+                          itemHandler:(void (^const)(id))itemHandler
+                    completionHandler:(const dispatch_block_t)completionHandler
+                       failureHandler:(void (^const)(NSError *))failureHandler {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _pageRequester = [pageRequester copy];
+    _itemHandler = [itemHandler copy];
+    _completionHandler = [completionHandler copy];
+    _failureHandler = [failureHandler copy];
+    _maximumBufferedPages = 2;
+    _delegateQueue = dispatch_get_main_queue();
+    return self;
+}
+
+
+- (void)setMaximumBufferedPages:(const NSUInteger)maximumBufferedPages {
+    if (0 == maximumBufferedPages) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one page must be buffered"];
+    }
+    _maximumBufferedPages = maximumBufferedPages;
+}
+
+
+- (void)start {
+    NSAssert(NSThread.isMainThread, @"Pipelines must be started on the main queue");
+    if (_started) {
+        [NSException raise:NSInternalInconsistencyException format:@"Pipeline already started"];
+    }
+    _started = YES;
+    [self requestNextPageIfPossible];
+}
+
+
+- (void)cancel {
+    self.cancelled = YES;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self finish];
+    });
+}
+
+
+- (void)requestNextPageIfPossible {
+    if (_inFlight || _exhausted || self.cancelled) {
+        return;
+    }
+    // The page in flight will be held once it arrives, so it counts too.
+    if (_heldPages + 1 > _maximumBufferedPages) {
+        return;
+    }
+
+    _inFlight = YES;
+    _pageRequester(^(NSArray *const items, const BOOL more, NSError *const error) {
+        NSCAssert(NSThread.isMainThread, @"Pages must be handed over on the main queue");
+        [self didReceivePage:items more:more error:error];
+    });
+}
+
+
+- (void)didReceivePage:(NSArray *const)items more:(const BOOL)more error:(NSError *const)error {
+    _inFlight = NO;
+    if (self.cancelled) {
+        return;
+    }
+
+    if (!items) {
+        self.cancelled = YES;
+        void (^const failureHandler)(NSError *) = _failureHandler;
+        dispatch_async(_delegateQueue, ^{
+            failureHandler(error);
+        });
+        [self finish];
+        return;
+    }
+    if (!more) {
+        _exhausted = YES;
+    }
+
+    // Pipeline: ask for the next page before this one is consumed.
+    ++_heldPages;
+    [self requestNextPageIfPossible];
+
+    void (^const itemHandler)(id) = _itemHandler;
+    dispatch_async(_delegateQueue, ^{
+        for (id const item in items) {
+            if (self.cancelled) {
+                break;
+            }
+            @autoreleasepool {
+                itemHandler(item);
+            }
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self didConsumePage];
+        });
+    });
+}
+
+
+- (void)didConsumePage {
+    --_heldPages;
+    if (self.cancelled) {
+        return;
+    }
+    if (_exhausted && 0 == _heldPages) {
+        const dispatch_block_t completionHandler = _completionHandler;
+        dispatch_async(_delegateQueue, ^{
+            if (!self.cancelled) {
+                completionHandler();
+            }
+        });
+        [self finish];
+        return;
+    }
+    [self requestNextPageIfPossible];
+}
+
+
+- (void)finish {
+    _exhausted = YES;
+    // The handlers hold the owner's delegate and usually the owner itself.
+    _pageRequester = nil;
+    _itemHandler = nil;
+    _completionHandler = nil;
+    _failureHandler = nil;
+}
+
+@end
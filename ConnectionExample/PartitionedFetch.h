@@ -0,0 +1,65 @@
+//
+//  PartitionedFetch.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "FetchStream.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Fetches a range of the topic tree as a number of disjoint partitions, several
+ of which are in flight at once, and returns the merged results in path order.
+
+ Partition boundaries are topic paths. With boundaries `b1 ... bn` the
+ partitions are `[start, b1)`, `[b1, b2)` ... `[bn, end]`, where start and end
+ are the range of the original request. Boundaries must be given in path order,
+ as returned by fetchBoundariesWithRequest:topicSelectorExpression:branchDepth:partitionCount:completionHandler:
+ */
+@interface PartitionedFetch : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *)request
+                    pageFetcher:(FetchStreamPageFetcher)pageFetcher
+                     boundaries:(NSArray<NSString *> *)boundaries NS_DESIGNATED_INITIALIZER;
+
+/**
+ The maximum number of partitions fetched at once. Defaults to 4.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentPartitions;
+
+/**
+ The page size used within each partition. Defaults to 1000.
+ */
+@property (nonatomic) UInt32 pageSize;
+
+/**
+ Fetches all partitions. The completion handler is called on the main queue
+ with every result in path order, or with the first error encountered, in
+ which case partitions still in flight are cancelled.
+ Must be called on the main queue, once.
+ */
+- (void)fetchWithCompletionHandler:(void (^)(NSArray<PTDiffusionFetchTopicResult *> * _Nullable results, NSError * _Nullable error))completionHandler;
+
+/**
+ Samples the tree with PTDiffusionFetchRequest#limitDeepBranches:limit: to find
+ the first topic of every branch at the given depth, then picks up to
+ `partitionCount - 1` of those paths, evenly spaced, as partition boundaries.
+ The completion handler is called on the main queue.
+ */
++ (void)fetchBoundariesWithRequest:(PTDiffusionFetchRequest *)request
+           topicSelectorExpression:(NSString *)expression
+                       branchDepth:(UInt32)branchDepth
+                    partitionCount:(NSUInteger)partitionCount
+                 completionHandler:(void (^)(NSArray<NSString *> * _Nullable boundaries, NSError * _Nullable error))completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
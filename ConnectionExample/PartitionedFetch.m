@@ -0,0 +1,198 @@
+//
+//  PartitionedFetch.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "PartitionedFetch.h"
+
+
+/**
+ Collects the results of one partition.
+ */
+@interface PartitionedFetchPartition : NSObject <FetchStreamDelegate>
+
+@property (nonatomic) NSUInteger index;
+@property (nonatomic) FetchStream *stream;
+@property (nonatomic, readonly) NSMutableArray<PTDiffusionFetchTopicResult *> *results;
+@property (nonatomic, copy) void (^completionHandler)(PartitionedFetchPartition *partition, NSError * _Nullable error);
+
+@end
+
+@implementation PartitionedFetchPartition
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _results = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (void)fetchStream:(FetchStream *const)stream didFetchTopicResult:(PTDiffusionFetchTopicResult *const)result {
+    [_results addObject:result];
+}
+
+- (void)fetchStreamDidComplete:(FetchStream *const)stream {
+    _completionHandler(self, nil);
+}
+
+- (void)fetchStream:(FetchStream *const)stream didFailWithError:(NSError *const)error {
+    _completionHandler(self, error);
+}
+
+@end
+
+
+@implementation PartitionedFetch {
+    PTDiffusionFetchRequest *_request;
+    FetchStreamPageFetcher _pageFetcher;
+    NSArray<NSString *> *_boundaries;
+    NSArray<PartitionedFetchPartition *> *_partitions;
+    NSUInteger _nextPartition;
+    NSUInteger _running;
+    NSUInteger _completed;
+    void (^_completionHandler)(NSArray<PTDiffusionFetchTopicResult *> *, NSError *);
+}
+
+
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *const)request
+                    pageFetcher:(const FetchStreamPageFetcher)pageFetcher
+                     boundaries:(NSArray<NSString *> *const)boundaries {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _request = request;
+    _pageFetcher = [pageFetcher copy];
+    _boundaries = [boundaries copy];
+    _maximumConcurrentPartitions = 4;
+    _pageSize = 1000;
+    return self;
+}
+
+
+- (void)setMaximumConcurrentPartitions:(const NSUInteger)maximumConcurrentPartitions {
+    if (0 == maximumConcurrentPartitions) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one partition must be fetched at a time"];
+    }
+    _maximumConcurrentPartitions = maximumConcurrentPartitions;
+}
+
+
+- (PTDiffusionFetchRequest *)requestForPartition:(const NSUInteger)index {
+    PTDiffusionFetchRequest *request = _request;
+    if (index > 0) {
+        request = [request fromTopicPath:_boundaries[index - 1]];
+    }
+    if (index < _boundaries.count) {
+        request = [request beforeTopicPath:_boundaries[index]];
+    }
+    return request;
+}
+
+
+- (void)fetchWithCompletionHandler:(void (^const)(NSArray<PTDiffusionFetchTopicResult *> *, NSError *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Partitioned fetches must be started on the main queue");
+    if (_completionHandler) {
+        [NSException raise:NSInternalInconsistencyException format:@"Fetch already started"];
+    }
+    _completionHandler = [completionHandler copy];
+
+    NSMutableArray<PartitionedFetchPartition *> *const partitions = [NSMutableArray new];
+    for (NSUInteger i = 0; i <= _boundaries.count; ++i) {
+        PartitionedFetchPartition *const partition = [PartitionedFetchPartition new];
+        partition.index = i;
+        partition.stream = [[FetchStream alloc] initWithRequest:[self requestForPartition:i]
+                                                       pageSize:_pageSize
+                                                    pageFetcher:_pageFetcher
+                                                       delegate:partition];
+        partition.completionHandler = ^(PartitionedFetchPartition *const p, NSError *const error) {
+            [self partition:p didCompleteWithError:error];
+        };
+        [partitions addObject:partition];
+    }
+    _partitions = partitions;
+    [self startPartitions];
+}
+
+
+- (void)startPartitions {
+    while (_running < _maximumConcurrentPartitions && _nextPartition < _partitions.count) {
+        ++_running;
+        [_partitions[_nextPartition++].stream start];
+    }
+}
+
+
+- (void)partition:(PartitionedFetchPartition *const)partition didCompleteWithError:(NSError *const)error {
+    if (!_completionHandler) {
+        // Already failed.
+        return;
+    }
+    --_running;
+    partition.stream = nil;
+
+    if (error) {
+        for (PartitionedFetchPartition *const p in _partitions) {
+            [p.stream cancel];
+        }
+        [self completeWithResults:nil error:error];
+        return;
+    }
+
+    if (++_completed < _partitions.count) {
+        [self startPartitions];
+        return;
+    }
+
+    // Partitions are disjoint and ordered, so merging is concatenation.
+    NSUInteger count = 0;
+    for (PartitionedFetchPartition *const p in _partitions) {
+        count += p.results.count;
+    }
+    NSMutableArray<PTDiffusionFetchTopicResult *> *const results = [NSMutableArray arrayWithCapacity:count];
+    for (PartitionedFetchPartition *const p in _partitions) {
+        [results addObjectsFromArray:p.results];
+    }
+    [self completeWithResults:results error:nil];
+}
+
+
+- (void)completeWithResults:(NSArray<PTDiffusionFetchTopicResult *> *const)results error:(NSError *const)error {
+    void (^const completionHandler)(NSArray<PTDiffusionFetchTopicResult *> *, NSError *) = _completionHandler;
+    _completionHandler = nil;
+    _partitions = nil;
+    completionHandler(results, error);
+}
+
+
++ (void)fetchBoundariesWithRequest:(PTDiffusionFetchRequest *const)request
+           topicSelectorExpression:(NSString *const)expression
+                       branchDepth:(const UInt32)branchDepth
+                    partitionCount:(const NSUInteger)partitionCount
+                 completionHandler:(void (^const)(NSArray<NSString *> *, NSError *))completionHandler {
+    [[request limitDeepBranches:branchDepth limit:1]
+        fetchWithTopicSelectorExpression:expression
+                       completionHandler:^(PTDiffusionFetchResult *const result, NSError *const error)
+    {
+        if (!result) {
+            completionHandler(nil, error);
+            return;
+        }
+        NSArray<PTDiffusionFetchTopicResult *> *const samples = result.results;
+        NSMutableArray<NSString *> *const boundaries = [NSMutableArray new];
+        if (partitionCount > 1) {
+            // The first sample starts the first partition anyway, so skip it.
+            for (NSUInteger i = 1; i < partitionCount; ++i) {
+                const NSUInteger index = i * samples.count / partitionCount;
+                NSString *const path = index < samples.count ? samples[index].path : nil;
+                if (index > 0 && path && ![path isEqualToString:boundaries.lastObject]) {
+                    [boundaries addObject:path];
+                }
+            }
+        }
+        completionHandler(boundaries, nil);
+    }];
+}
+
+@end
@@ -0,0 +1,113 @@
+//
+//  PriorityScheduler.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "RequestWindow.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A snapshot of the state of one lane of a PriorityScheduler.
+ */
+@interface PrioritySchedulerLaneMetrics : NSObject
+
+@property (nonatomic, readonly) PTDiffusionSendDeliveryPriority priority;
+
+/**
+ Operations waiting to start.
+ */
+@property (nonatomic, readonly) NSUInteger queueDepth;
+
+@property (nonatomic, readonly) NSUInteger maximumQueueDepth;
+
+/**
+ Operations started but not yet done.
+ */
+@property (nonatomic, readonly) NSUInteger outstanding;
+
+@property (nonatomic, readonly) NSUInteger completedCount;
+
+/**
+ Time from submission to start, over all started operations.
+ */
+@property (nonatomic, readonly) NSTimeInterval averageQueueLatency;
+
+@property (nonatomic, readonly) NSTimeInterval maximumQueueLatency;
+
+/**
+ Time from submission to done, over all completed operations.
+ */
+@property (nonatomic, readonly) NSTimeInterval averageCompletionLatency;
+
+@end
+
+
+/**
+ Schedules outbound operations for a session in separate lanes, one for each
+ PTDiffusionSendDeliveryPriority.
+
+ The client library has a single outbound queue for a session. Routing sends
+ through a scheduler keeps the number of operations in that queue at or below
+ maximumOutstandingOperations, and chooses which lane gets each free slot by
+ smooth weighted round robin. With the default weights of 8 (high), 4 (normal)
+ and 1 (low), a bulk fetch or snapshot submitted at low priority cannot hold
+ back latency-critical requests and updates by more than one slot's worth of
+ work. A lane can also be given its own limit so it never takes every slot.
+
+ Instances are confined to the main queue.
+ */
+@interface PriorityScheduler : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSession:(nullable PTDiffusionSession *)session
+    maximumOutstandingOperations:(NSUInteger)maximumOutstandingOperations NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, nullable) PTDiffusionSession *session;
+
+@property (nonatomic) NSUInteger maximumOutstandingOperations;
+
+/**
+ Sets the relative share of free slots given to a lane. Must be at least 1.
+ */
+- (void)setWeight:(NSUInteger)weight forPriority:(PTDiffusionSendDeliveryPriority)priority;
+
+/**
+ Limits the operations one lane may have outstanding. Defaults to no limit
+ beyond maximumOutstandingOperations.
+ */
+- (void)setMaximumOutstandingOperations:(NSUInteger)maximumOutstandingOperations
+                            forPriority:(PTDiffusionSendDeliveryPriority)priority;
+
+- (void)performOperation:(RequestWindowOperation)operation
+                priority:(PTDiffusionSendDeliveryPriority)priority;
+
+/**
+ Sends a request expecting a JSON response in the given lane.
+ */
+- (void)       sendRequest:(PTDiffusionRequest *)request
+                    toPath:(NSString *)path
+                  priority:(PTDiffusionSendDeliveryPriority)priority
+     JSONCompletionHandler:(void (^)(PTDiffusionJSON * _Nullable json, NSError * _Nullable error))completionHandler;
+
+/**
+ Sends a fetch in the given lane, typically PTDiffusionSendDeliveryPriority_Low
+ for bulk fetches.
+ */
+- (void)fetchWithRequest:(PTDiffusionFetchRequest *)request
+ topicSelectorExpression:(NSString *)expression
+                priority:(PTDiffusionSendDeliveryPriority)priority
+       completionHandler:(void (^)(PTDiffusionFetchResult * _Nullable result, NSError * _Nullable error))completionHandler;
+
+- (PrioritySchedulerLaneMetrics *)metricsForPriority:(PTDiffusionSendDeliveryPriority)priority;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,309 @@
+//
+//  PriorityScheduler.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "PriorityScheduler.h"
+
+
+static const NSUInteger _LaneCount = 3;
+
+
+static NSUInteger _LaneIndex(const PTDiffusionSendDeliveryPriority priority) {
+    switch (priority) {
+        case PTDiffusionSendDeliveryPriority_High:
+            return 0;
+        case PTDiffusionSendDeliveryPriority_Normal:
+            return 1;
+        case PTDiffusionSendDeliveryPriority_Low:
+            return 2;
+    }
+    [NSException raise:NSInvalidArgumentException format:@"Unknown priority %lu", (unsigned long)priority];
+    return 0;
+}
+
+
+@interface PrioritySchedulerLaneMetrics ()
+
+@property (nonatomic, readwrite) PTDiffusionSendDeliveryPriority priority;
+@property (nonatomic, readwrite) NSUInteger queueDepth;
+@property (nonatomic, readwrite) NSUInteger maximumQueueDepth;
+@property (nonatomic, readwrite) NSUInteger outstanding;
+@property (nonatomic, readwrite) NSUInteger completedCount;
+@property (nonatomic, readwrite) NSTimeInterval averageQueueLatency;
+@property (nonatomic, readwrite) NSTimeInterval maximumQueueLatency;
+@property (nonatomic, readwrite) NSTimeInterval averageCompletionLatency;
+
+@end
+
+@implementation PrioritySchedulerLaneMetrics
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@: queued=%lu (max %lu) outstanding=%lu completed=%lu wait avg=%.3fms max=%.3fms total avg=%.3fms",
+            PTDiffusionSendDeliveryPriorityToString(_priority),
+            (unsigned long)_queueDepth, (unsigned long)_maximumQueueDepth,
+            (unsigned long)_outstanding, (unsigned long)_completedCount,
+            _averageQueueLatency * 1000.0, _maximumQueueLatency * 1000.0,
+            _averageCompletionLatency * 1000.0];
+}
+
+@end
+
+
+/**
+ An operation waiting in a lane.
+ */
+@interface PrioritySchedulerEntry : NSObject
+
+@property (nonatomic, copy) RequestWindowOperation operation;
+@property (nonatomic) uint64_t submitted;
+
+@end
+
+@implementation PrioritySchedulerEntry
+@end
+
+
+/**
+ The queue and counters for one priority.
+ */
+@interface PrioritySchedulerLane : NSObject
+
+@property (nonatomic) PTDiffusionSendDeliveryPriority priority;
+@property (nonatomic, readonly) NSMutableArray<PrioritySchedulerEntry *> *queue;
+@property (nonatomic) NSUInteger weight;
+@property (nonatomic) NSInteger currentWeight;
+@property (nonatomic) NSUInteger maximumOutstanding;
+@property (nonatomic) NSUInteger outstanding;
+@property (nonatomic) NSUInteger maximumQueueDepth;
+@property (nonatomic) NSUInteger startedCount;
+@property (nonatomic) NSUInteger completedCount;
+@property (nonatomic) uint64_t totalQueueNanoseconds;
+@property (nonatomic) uint64_t maximumQueueNanoseconds;
+@property (nonatomic) uint64_t totalCompletionNanoseconds;
+
+@end
+
+@implementation PrioritySchedulerLane
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _queue = [NSMutableArray new];
+        _maximumOutstanding = NSUIntegerMax;
+    }
+    return self;
+}
+
+- (BOOL)isEligible {
+    return _queue.count > 0 && _outstanding < _maximumOutstanding;
+}
+
+@end
+
+
+@implementation PriorityScheduler {
+    NSArray<PrioritySchedulerLane *> *_lanes;
+    // Admits one claim per queued operation. A claim chooses which lane's
+    // operation to run only once it is admitted.
+    RequestWindow *_window;
+    // Admitted claims for which every lane with work was at its own limit.
+    NSMutableArray<dispatch_block_t> *_parkedClaims;
+}
+
+
+- (instancetype)initWithSession:(PTDiffusionSession *const)session
+    maximumOutstandingOperations:(const NSUInteger)maximumOutstandingOperations {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _window = [[RequestWindow alloc] initWithSession:session maximumOutstandingRequests:maximumOutstandingOperations];
+    _parkedClaims = [NSMutableArray new];
+
+    const PTDiffusionSendDeliveryPriority priorities[_LaneCount] = {
+        PTDiffusionSendDeliveryPriority_High,
+        PTDiffusionSendDeliveryPriority_Normal,
+        PTDiffusionSendDeliveryPriority_Low,
+    };
+    const NSUInteger weights[_LaneCount] = {8, 4, 1};
+    NSMutableArray<PrioritySchedulerLane *> *const lanes = [NSMutableArray new];
+    for (NSUInteger i = 0; i < _LaneCount; ++i) {
+        PrioritySchedulerLane *const lane = [PrioritySchedulerLane new];
+        lane.priority = priorities[i];
+        lane.weight = weights[i];
+        [lanes addObject:lane];
+    }
+    _lanes = lanes;
+    return self;
+}
+
+
+- (PTDiffusionSession *)session {
+    return _window.session;
+}
+
+
+- (NSUInteger)maximumOutstandingOperations {
+    return _window.maximumOutstandingRequests;
+}
+
+
+- (void)setMaximumOutstandingOperations:(const NSUInteger)maximumOutstandingOperations {
+    _window.maximumOutstandingRequests = maximumOutstandingOperations;
+}
+
+
+- (void)setWeight:(const NSUInteger)weight forPriority:(const PTDiffusionSendDeliveryPriority)priority {
+    if (0 == weight) {
+        [NSException raise:NSInvalidArgumentException format:@"Weight must be at least 1"];
+    }
+    _lanes[_LaneIndex(priority)].weight = weight;
+}
+
+
+- (void)setMaximumOutstandingOperations:(const NSUInteger)maximumOutstandingOperations
+                            forPriority:(const PTDiffusionSendDeliveryPriority)priority {
+    if (0 == maximumOutstandingOperations) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one operation must be allowed"];
+    }
+    _lanes[_LaneIndex(priority)].maximumOutstanding = maximumOutstandingOperations;
+    [self startParkedClaims];
+}
+
+
+- (void)performOperation:(const RequestWindowOperation)operation
+                priority:(const PTDiffusionSendDeliveryPriority)priority {
+    NSAssert(NSThread.isMainThread, @"Schedulers are confined to the main queue");
+    PrioritySchedulerLane *const lane = _lanes[_LaneIndex(priority)];
+    PrioritySchedulerEntry *const entry = [PrioritySchedulerEntry new];
+    entry.operation = operation;
+    entry.submitted = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    [lane.queue addObject:entry];
+    lane.maximumQueueDepth = MAX(lane.maximumQueueDepth, lane.queue.count);
+
+    // One claim per entry, so that an entry left queued behind its lane's
+    // limit always has a claim to run it.
+    [_window performOperation:^(const dispatch_block_t done) {
+        [self startOperationWithClaim:done];
+    }];
+    // The new entry may be able to use a claim parked for a limited lane.
+    [self startParkedClaims];
+}
+
+
+/**
+ Smooth weighted round robin over the lanes that have work and capacity.
+ */
+- (PrioritySchedulerLane *)nextLane {
+    PrioritySchedulerLane *selected = nil;
+    NSInteger totalWeight = 0;
+    for (PrioritySchedulerLane *const lane in _lanes) {
+        if (!lane.isEligible) {
+            continue;
+        }
+        lane.currentWeight += lane.weight;
+        totalWeight += lane.weight;
+        if (!selected || lane.currentWeight > selected.currentWeight) {
+            selected = lane;
+        }
+    }
+    selected.currentWeight -= totalWeight;
+    return selected;
+}
+
+
+- (BOOL)hasEligibleLane {
+    for (PrioritySchedulerLane *const lane in _lanes) {
+        if (lane.isEligible) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+
+- (void)startOperationWithClaim:(const dispatch_block_t)done {
+    PrioritySchedulerLane *const lane = [self nextLane];
+    if (!lane) {
+        [_parkedClaims addObject:done];
+        return;
+    }
+    PrioritySchedulerEntry *const entry = lane.queue.firstObject;
+    [lane.queue removeObjectAtIndex:0];
+
+    const uint64_t submitted = entry.submitted;
+    const uint64_t waited = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - submitted;
+    lane.totalQueueNanoseconds += waited;
+    lane.maximumQueueNanoseconds = MAX(lane.maximumQueueNanoseconds, waited);
+    lane.startedCount++;
+    lane.outstanding++;
+
+    entry.operation(^{
+        lane.totalCompletionNanoseconds += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - submitted;
+        lane.completedCount++;
+        lane.outstanding--;
+        done();
+        [self startParkedClaims];
+    });
+}
+
+
+- (void)startParkedClaims {
+    while (_parkedClaims.count > 0 && [self hasEligibleLane]) {
+        const dispatch_block_t done = _parkedClaims.firstObject;
+        [_parkedClaims removeObjectAtIndex:0];
+        [self startOperationWithClaim:done];
+    }
+}
+
+
+- (void)       sendRequest:(PTDiffusionRequest *const)request
+                    toPath:(NSString *const)path
+                  priority:(const PTDiffusionSendDeliveryPriority)priority
+     JSONCompletionHandler:(void (^const)(PTDiffusionJSON *, NSError *))completionHandler {
+    PTDiffusionSession *const session = self.session;
+    if (!session) {
+        [NSException raise:NSInternalInconsistencyException format:@"Scheduler has no session"];
+    }
+    [self performOperation:^(const dispatch_block_t done) {
+        [session.messaging sendRequest:request toPath:path JSONCompletionHandler:^(PTDiffusionJSON *const json, NSError *const error) {
+            done();
+            completionHandler(json, error);
+        }];
+    } priority:priority];
+}
+
+
+- (void)fetchWithRequest:(PTDiffusionFetchRequest *const)request
+ topicSelectorExpression:(NSString *const)expression
+                priority:(const PTDiffusionSendDeliveryPriority)priority
+       completionHandler:(void (^const)(PTDiffusionFetchResult *, NSError *))completionHandler {
+    [self performOperation:^(const dispatch_block_t done) {
+        [request fetchWithTopicSelectorExpression:expression completionHandler:^(PTDiffusionFetchResult *const result, NSError *const error) {
+            done();
+            completionHandler(result, error);
+        }];
+    } priority:priority];
+}
+
+
+- (PrioritySchedulerLaneMetrics *)metricsForPriority:(const PTDiffusionSendDeliveryPriority)priority {
+    PrioritySchedulerLane *const lane = _lanes[_LaneIndex(priority)];
+    PrioritySchedulerLaneMetrics *const metrics = [PrioritySchedulerLaneMetrics new];
+    metrics.priority = priority;
+    metrics.queueDepth = lane.queue.count;
+    metrics.maximumQueueDepth = lane.maximumQueueDepth;
+    metrics.outstanding = lane.outstanding;
+    metrics.completedCount = lane.completedCount;
+    if (lane.startedCount > 0) {
+        metrics.averageQueueLatency = lane.totalQueueNanoseconds / (double)lane.startedCount / NSEC_PER_SEC;
+    }
+    metrics.maximumQueueLatency = lane.maximumQueueNanoseconds / (double)NSEC_PER_SEC;
+    if (lane.completedCount > 0) {
+        metrics.averageCompletionLatency = lane.totalCompletionNanoseconds / (double)lane.completedCount / NSEC_PER_SEC;
+    }
+    return metrics;
+}
+
+@end
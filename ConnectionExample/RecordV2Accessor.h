@@ -0,0 +1,154 @@
+//
+//  RecordV2Accessor.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, RecordV2FieldType) {
+    RecordV2FieldType_String,
+    RecordV2FieldType_Integer,
+    RecordV2FieldType_Decimal,
+};
+
+/**
+ A field resolved against a schema. Only the last record and the last field of
+ a record may have variable multiplicity, so the position of every occurrence
+ is fixed by the schema.
+ */
+typedef struct {
+    /** The position of the record occurrence within the value. */
+    uint32_t record;
+    /** The position of the field occurrence within its record. */
+    uint32_t field;
+    RecordV2FieldType type;
+    /** The scale of a decimal field, otherwise zero. */
+    int32_t scale;
+} RecordV2FieldHandle;
+
+/**
+ The encoded bytes of one field, pointing into the data of a
+ PTDiffusionRecordV2 and valid for as long as it is. `bytes` is `NULL` if the
+ value does not have the field.
+ */
+typedef struct {
+    const char *bytes;
+    NSUInteger length;
+} RecordV2FieldSlice;
+
+/**
+ RecordV2 encoding: records are separated by RecordV2RecordDelimiter and fields
+ by RecordV2FieldDelimiter; an empty field on its own is written as
+ RecordV2EmptyField.
+ */
+extern const char RecordV2RecordDelimiter;
+extern const char RecordV2FieldDelimiter;
+extern const char RecordV2EmptyField;
+
+/**
+ Walks the fields of an encoded value in order. `bytes` is `NULL` once all have
+ been read. The data the cursor was made from must outlive it.
+ */
+typedef struct {
+    const char *bytes;
+    const char *end;
+    uint32_t record;
+    uint32_t field;
+} RecordV2FieldCursor;
+
+extern RecordV2FieldCursor RecordV2FieldCursorMake(NSData *data);
+
+/**
+ Reads the next field and its position.
+
+ @param endsRecord Set if the field is the last of its record.
+ @return `NO` if there are no more fields.
+ */
+extern BOOL RecordV2FieldCursorNext(RecordV2FieldCursor *cursor,
+                                    uint32_t *record,
+                                    uint32_t *field,
+                                    RecordV2FieldSlice *slice,
+                                    BOOL *endsRecord);
+
+/**
+ Reads fields from PTDiffusionRecordV2 values of one schema without building a
+ PTDiffusionRecordV2Model or creating strings.
+
+ Keys of the form `recordName(recordIndex).fieldName(fieldIndex)`, as accepted
+ by PTDiffusionRecordV2Model#fieldValueForKey:error:, are resolved once into
+ handles. Reads then walk the record and field delimiters of the value's bytes
+ directly.
+
+ Instances are immutable and can be shared between threads.
+ */
+@interface RecordV2Accessor : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSchema:(PTDiffusionRecordV2Schema *)schema NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) PTDiffusionRecordV2Schema *schema;
+
+/**
+ @exception NSInvalidArgumentException If the key is malformed or does not
+ address a field the schema allows.
+ */
+- (RecordV2FieldHandle)handleForKey:(NSString *)key;
+
+/**
+ As handleForKey: for a key given in parts, as in PTDiffusionRecordV2DeltaChange.
+ */
+- (RecordV2FieldHandle)handleForRecordName:(NSString *)recordName
+                               recordIndex:(SInt32)recordIndex
+                                 fieldName:(NSString *)fieldName
+                                fieldIndex:(SInt32)fieldIndex;
+
+- (RecordV2FieldSlice)sliceForField:(RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *)record;
+
+/**
+ Finds several fields in one pass over the value.
+ */
+- (void)getSlices:(RecordV2FieldSlice *)slices
+        forFields:(const RecordV2FieldHandle *)handles
+            count:(NSUInteger)count
+         ofRecord:(PTDiffusionRecordV2 *)record;
+
+/**
+ @return `NO` if the value does not have the field or it is not an integer.
+ */
+- (BOOL)getInt64:(int64_t *)value forField:(RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *)record;
+
+/**
+ Reads a decimal field as an integer scaled by 10^handle.scale, so "12.5" in a
+ field of scale 2 reads as 1250.
+
+ @return `NO` if the value does not have the field or it is not a decimal.
+ */
+- (BOOL)getUnscaledDecimal:(int64_t *)value forField:(RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *)record;
+
+- (BOOL)getDouble:(double *)value forField:(RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *)record;
+
+/**
+ Creates a string for a field, or returns `nil` if the value does not have it.
+ */
+- (nullable NSString *)stringForField:(RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *)record;
+
++ (RecordV2FieldType)fieldTypeOfSchemaField:(PTDiffusionRecordV2SchemaField *)field;
+
+/**
+ Parses an integer field. Exposed for callers holding slices.
+ */
++ (BOOL)parseInt64:(int64_t *)value fromSlice:(RecordV2FieldSlice)slice;
+
++ (BOOL)parseUnscaledDecimal:(int64_t *)value scale:(int32_t)scale fromSlice:(RecordV2FieldSlice)slice;
+
+@end
+
+NS_ASSUME_NONNULL_END
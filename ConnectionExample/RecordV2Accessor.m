@@ -0,0 +1,291 @@
+//
+//  RecordV2Accessor.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RecordV2Accessor.h"
+
+
+const char RecordV2RecordDelimiter = 0x01;
+const char RecordV2FieldDelimiter = 0x02;
+const char RecordV2EmptyField = 0x03;
+
+
+RecordV2FieldCursor RecordV2FieldCursorMake(NSData *const data) {
+    RecordV2FieldCursor cursor;
+    cursor.bytes = data.length > 0 ? data.bytes : NULL;
+    cursor.end = cursor.bytes + data.length;
+    cursor.record = 0;
+    cursor.field = 0;
+    return cursor;
+}
+
+
+BOOL RecordV2FieldCursorNext(RecordV2FieldCursor *const cursor,
+                             uint32_t *const record,
+                             uint32_t *const field,
+                             RecordV2FieldSlice *const slice,
+                             BOOL *const endsRecord) {
+    if (!cursor->bytes) {
+        return NO;
+    }
+    const char *c = cursor->bytes;
+    while (c != cursor->end && RecordV2RecordDelimiter != *c && RecordV2FieldDelimiter != *c) {
+        ++c;
+    }
+    slice->bytes = cursor->bytes;
+    slice->length = c - cursor->bytes;
+    if (1 == slice->length && RecordV2EmptyField == *slice->bytes) {
+        slice->length = 0;
+    }
+    *record = cursor->record;
+    *field = cursor->field;
+    if (c == cursor->end) {
+        *endsRecord = YES;
+        cursor->bytes = NULL;
+    } else if (RecordV2RecordDelimiter == *c) {
+        *endsRecord = YES;
+        ++cursor->record;
+        cursor->field = 0;
+        cursor->bytes = c + 1;
+    } else {
+        *endsRecord = NO;
+        ++cursor->field;
+        cursor->bytes = c + 1;
+    }
+    return YES;
+}
+
+
+/**
+ Splits `name(index)` or `name` into its parts.
+ */
+static NSString *_ParseNode(NSString *const node, SInt32 *const index, NSString *const key) {
+    const NSRange open = [node rangeOfString:@"("];
+    if (NSNotFound == open.location) {
+        *index = 0;
+        return node;
+    }
+    if (![node hasSuffix:@")"]) {
+        [NSException raise:NSInvalidArgumentException format:@"Invalid key \"%@\"", key];
+    }
+    NSString *const digits = [node substringWithRange:
+        NSMakeRange(NSMaxRange(open), node.length - NSMaxRange(open) - 1)];
+    NSScanner *const scanner = [NSScanner scannerWithString:digits];
+    int parsed = 0;
+    if (![scanner scanInt:&parsed] || !scanner.isAtEnd || parsed < 0) {
+        [NSException raise:NSInvalidArgumentException format:@"Invalid index in key \"%@\"", key];
+    }
+    *index = parsed;
+    return [node substringToIndex:open.location];
+}
+
+
+@implementation RecordV2Accessor
+
+
+- (instancetype)initWithSchema:(PTDiffusionRecordV2Schema *const)schema {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _schema = schema;
+    return self;
+}
+
+
+- (RecordV2FieldHandle)handleForKey:(NSString *const)key {
+    NSString *recordPart = nil;
+    NSString *fieldPart = key;
+    const NSRange dot = [key rangeOfString:@"."];
+    if (NSNotFound != dot.location) {
+        recordPart = [key substringToIndex:dot.location];
+        fieldPart = [key substringFromIndex:NSMaxRange(dot)];
+    }
+
+    SInt32 recordIndex = 0;
+    NSString *const recordName = recordPart ? _ParseNode(recordPart, &recordIndex, key) : _schema.records.firstObject.name;
+    SInt32 fieldIndex = 0;
+    NSString *const fieldName = _ParseNode(fieldPart, &fieldIndex, key);
+    return [self handleForRecordName:recordName recordIndex:recordIndex fieldName:fieldName fieldIndex:fieldIndex];
+}
+
+
+- (RecordV2FieldHandle)handleForRecordName:(NSString *const)recordName
+                               recordIndex:(const SInt32)recordIndex
+                                 fieldName:(NSString *const)fieldName
+                                fieldIndex:(const SInt32)fieldIndex {
+    if (recordIndex < 0 || fieldIndex < 0) {
+        [NSException raise:NSInvalidArgumentException format:@"Negative index"];
+    }
+    // Only the last node at each level may vary, so earlier ones always occur
+    // exactly max times.
+    uint32_t recordPosition = 0;
+    PTDiffusionRecordV2SchemaRecord *record = nil;
+    for (PTDiffusionRecordV2SchemaRecord *const candidate in _schema.records) {
+        if ([candidate.name isEqualToString:recordName]) {
+            record = candidate;
+            break;
+        }
+        recordPosition += candidate.max;
+    }
+    if (!record || (record.max >= 0 && recordIndex >= record.max)) {
+        [NSException raise:NSInvalidArgumentException format:@"No record %@(%d)", recordName, recordIndex];
+    }
+
+    uint32_t fieldPosition = 0;
+    PTDiffusionRecordV2SchemaField *field = nil;
+    for (PTDiffusionRecordV2SchemaField *const candidate in record.fields) {
+        if ([candidate.name isEqualToString:fieldName]) {
+            field = candidate;
+            break;
+        }
+        fieldPosition += candidate.max;
+    }
+    if (!field || (field.max >= 0 && fieldIndex >= field.max)) {
+        [NSException raise:NSInvalidArgumentException format:@"No field %@(%d).%@(%d)", recordName, recordIndex, fieldName, fieldIndex];
+    }
+
+    RecordV2FieldHandle handle = {0};
+    handle.record = recordPosition + (uint32_t)recordIndex;
+    handle.field = fieldPosition + (uint32_t)fieldIndex;
+    handle.type = [RecordV2Accessor fieldTypeOfSchemaField:field];
+    handle.scale = field.scale;
+    return handle;
+}
+
+
++ (RecordV2FieldType)fieldTypeOfSchemaField:(PTDiffusionRecordV2SchemaField *const)field {
+    if ([field.type isEqual:PTDiffusionRecordV2SchemaFieldType.integer]) {
+        return RecordV2FieldType_Integer;
+    }
+    if ([field.type isEqual:PTDiffusionRecordV2SchemaFieldType.decimal]) {
+        return RecordV2FieldType_Decimal;
+    }
+    return RecordV2FieldType_String;
+}
+
+
+- (void)getSlices:(RecordV2FieldSlice *const)slices
+        forFields:(const RecordV2FieldHandle *const)handles
+            count:(const NSUInteger)count
+         ofRecord:(PTDiffusionRecordV2 *const)record {
+    for (NSUInteger i = 0; i < count; ++i) {
+        slices[i].bytes = NULL;
+        slices[i].length = 0;
+    }
+    if (0 == count) {
+        return;
+    }
+
+    NSData *const data = record.data;
+    RecordV2FieldCursor cursor = RecordV2FieldCursorMake(data);
+    NSUInteger remaining = count;
+    uint32_t recordPosition, fieldPosition;
+    RecordV2FieldSlice slice;
+    BOOL endsRecord;
+    while (remaining > 0 && RecordV2FieldCursorNext(&cursor, &recordPosition, &fieldPosition, &slice, &endsRecord)) {
+        for (NSUInteger i = 0; i < count; ++i) {
+            if (!slices[i].bytes && handles[i].record == recordPosition && handles[i].field == fieldPosition) {
+                slices[i] = slice;
+                --remaining;
+            }
+        }
+    }
+}
+
+
+- (RecordV2FieldSlice)sliceForField:(const RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *const)record {
+    RecordV2FieldSlice slice;
+    [self getSlices:&slice forFields:&handle count:1 ofRecord:record];
+    return slice;
+}
+
+
++ (BOOL)parseInt64:(int64_t *const)value fromSlice:(const RecordV2FieldSlice)slice {
+    return [self parseUnscaledDecimal:value scale:0 fromSlice:slice];
+}
+
+
++ (BOOL)parseUnscaledDecimal:(int64_t *const)value scale:(const int32_t)scale fromSlice:(const RecordV2FieldSlice)slice {
+    const char *c = slice.bytes;
+    const char *const end = c + slice.length;
+    if (!c || c == end) {
+        return NO;
+    }
+    const BOOL negative = '-' == *c;
+    if (negative && ++c == end) {
+        return NO;
+    }
+    // Accumulate negatively so that INT64_MIN can be represented.
+    int64_t result = 0;
+    int32_t fractionDigits = -1;
+    for (; c != end; ++c) {
+        if ('.' == *c && fractionDigits < 0 && scale > 0) {
+            fractionDigits = 0;
+            continue;
+        }
+        if (*c < '0' || *c > '9') {
+            return NO;
+        }
+        if (fractionDigits >= 0 && ++fractionDigits > scale) {
+            return NO;
+        }
+        if (__builtin_mul_overflow(result, 10, &result) || __builtin_sub_overflow(result, *c - '0', &result)) {
+            return NO;
+        }
+    }
+    for (int32_t i = MAX(fractionDigits, 0); i < scale; ++i) {
+        if (__builtin_mul_overflow(result, 10, &result)) {
+            return NO;
+        }
+    }
+    if (!negative && INT64_MIN == result) {
+        return NO;
+    }
+    *value = negative ? result : -result;
+    return YES;
+}
+
+
+- (BOOL)getInt64:(int64_t *const)value forField:(const RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *const)record {
+    if (RecordV2FieldType_Integer != handle.type) {
+        return NO;
+    }
+    return [RecordV2Accessor parseInt64:value fromSlice:[self sliceForField:handle ofRecord:record]];
+}
+
+
+- (BOOL)getUnscaledDecimal:(int64_t *const)value forField:(const RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *const)record {
+    if (RecordV2FieldType_Decimal != handle.type) {
+        return NO;
+    }
+    return [RecordV2Accessor parseUnscaledDecimal:value
+                                            scale:handle.scale
+                                        fromSlice:[self sliceForField:handle ofRecord:record]];
+}
+
+
+- (BOOL)getDouble:(double *const)value forField:(const RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *const)record {
+    int64_t unscaled = 0;
+    if (RecordV2FieldType_String == handle.type ||
+        ![RecordV2Accessor parseUnscaledDecimal:&unscaled
+                                          scale:handle.scale
+                                      fromSlice:[self sliceForField:handle ofRecord:record]]) {
+        return NO;
+    }
+    *value = unscaled / pow(10.0, handle.scale);
+    return YES;
+}
+
+
+- (NSString *)stringForField:(const RecordV2FieldHandle)handle ofRecord:(PTDiffusionRecordV2 *const)record {
+    const RecordV2FieldSlice slice = [self sliceForField:handle ofRecord:record];
+    if (!slice.bytes) {
+        return nil;
+    }
+    return [[NSString alloc] initWithBytes:slice.bytes length:slice.length encoding:NSUTF8StringEncoding];
+}
+
+@end
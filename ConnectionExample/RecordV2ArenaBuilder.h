@@ -0,0 +1,80 @@
+//
+//  RecordV2ArenaBuilder.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Builds PTDiffusionRecordV2 values by writing fields straight into a growable
+ byte buffer, for publishers that encode many records in a row.
+
+ Unlike PTDiffusionRecordV2Builder, fields are given as C strings, UTF-8 bytes
+ or numbers rather than as arrays of NSString, and reset keeps the buffer so
+ that a builder reused for each record stops allocating once the buffer has
+ grown to fit. The only copy is the one made by build.
+
+ Records without fields cannot be represented. Instances are not thread safe.
+ */
+@interface RecordV2ArenaBuilder : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @param capacity The initial size of the buffer in bytes.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ Starts a new record. Fields added before the first call go into the first
+ record.
+ */
+- (void)beginRecord;
+
+- (void)addUTF8Bytes:(const char *)bytes length:(NSUInteger)length;
+
+- (void)addCString:(const char *)string;
+
+- (void)addString:(NSString *)string;
+
+/**
+ Adds an integer field.
+ */
+- (void)addInt64:(int64_t)value;
+
+/**
+ Adds a decimal field of the given scale from its value scaled by 10^scale, so
+ 1250 at scale 2 is written as "12.50".
+ */
+- (void)addUnscaledDecimal:(int64_t)value scale:(int32_t)scale;
+
+/**
+ Adds a decimal field of the given scale, rounding half away from zero.
+ */
+- (void)addDouble:(double)value scale:(int32_t)scale;
+
+/**
+ Discards the fields added so far but keeps the buffer.
+ */
+- (void)reset;
+
+/**
+ The encoded length of what has been added so far.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
+/**
+ A record value holding a copy of the encoded bytes.
+ */
+- (PTDiffusionRecordV2 *)build;
+
+@end
+
+NS_ASSUME_NONNULL_END
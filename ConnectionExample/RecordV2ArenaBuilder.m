@@ -0,0 +1,169 @@
+//
+//  RecordV2ArenaBuilder.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RecordV2ArenaBuilder.h"
+#import "RecordV2Accessor.h"
+
+
+// Enough for a sign, the 19 digits of INT64_MIN and a decimal point.
+static const NSUInteger _MaximumInt64Length = 21;
+
+
+@implementation RecordV2ArenaBuilder {
+    char *_bytes;
+    NSUInteger _capacity;
+    BOOL _recordHasFields;
+}
+
+
+- (instancetype)initWithCapacity:(const NSUInteger)capacity {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _capacity = MAX(capacity, (NSUInteger)64);
+    _bytes = malloc(_capacity);
+    if (!_bytes) {
+        [NSException raise:NSMallocException format:@"Unable to allocate %lu bytes", (unsigned long)_capacity];
+    }
+    return self;
+}
+
+
+- (void)dealloc {
+    free(_bytes);
+}
+
+
+- (void)reserve:(const NSUInteger)additional {
+    if (_length + additional <= _capacity) {
+        return;
+    }
+    NSUInteger capacity = _capacity;
+    while (capacity < _length + additional) {
+        capacity *= 2;
+    }
+    char *const bytes = realloc(_bytes, capacity);
+    if (!bytes) {
+        [NSException raise:NSMallocException format:@"Unable to allocate %lu bytes", (unsigned long)capacity];
+    }
+    _bytes = bytes;
+    _capacity = capacity;
+}
+
+
+- (void)beginRecord {
+    if (_length > 0) {
+        [self reserve:1];
+        _bytes[_length++] = RecordV2RecordDelimiter;
+    }
+    _recordHasFields = NO;
+}
+
+
+/**
+ Writes the delimiter before a field and makes room for it.
+ */
+- (char *)startFieldOfLength:(const NSUInteger)length {
+    [self reserve:length + 2];
+    if (_recordHasFields) {
+        _bytes[_length++] = RecordV2FieldDelimiter;
+    }
+    _recordHasFields = YES;
+    return _bytes + _length;
+}
+
+
+- (void)addUTF8Bytes:(const char *const)bytes length:(const NSUInteger)length {
+    char *const field = [self startFieldOfLength:length];
+    if (0 == length) {
+        *field = RecordV2EmptyField;
+        _length += 1;
+        return;
+    }
+    memcpy(field, bytes, length);
+    _length += length;
+}
+
+
+- (void)addCString:(const char *const)string {
+    [self addUTF8Bytes:string length:strlen(string)];
+}
+
+
+- (void)addString:(NSString *const)string {
+    const NSUInteger maximumLength = [string maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    char *const field = [self startFieldOfLength:maximumLength];
+    NSUInteger usedLength = 0;
+    [string getBytes:field
+           maxLength:maximumLength
+          usedLength:&usedLength
+            encoding:NSUTF8StringEncoding
+             options:0
+               range:NSMakeRange(0, string.length)
+      remainingRange:NULL];
+    if (0 == usedLength) {
+        *field = RecordV2EmptyField;
+        usedLength = 1;
+    }
+    _length += usedLength;
+}
+
+
+- (void)addInt64:(const int64_t)value {
+    [self addUnscaledDecimal:value scale:0];
+}
+
+
+- (void)addUnscaledDecimal:(const int64_t)value scale:(const int32_t)scale {
+    if (scale < 0 || scale > 18) {
+        [NSException raise:NSInvalidArgumentException format:@"Unsupported scale %d", scale];
+    }
+    // Digits are produced least significant first into a scratch buffer.
+    char digits[_MaximumInt64Length];
+    NSUInteger count = 0;
+    // Work with the magnitude as unsigned so that INT64_MIN is handled.
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    do {
+        digits[count++] = '0' + (char)(magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= (NSUInteger)scale);
+
+    char *const field = [self startFieldOfLength:count + 2];
+    char *out = field;
+    if (value < 0) {
+        *out++ = '-';
+    }
+    for (NSUInteger i = count; i > 0; --i) {
+        if (i == (NSUInteger)scale && scale > 0) {
+            *out++ = '.';
+        }
+        *out++ = digits[i - 1];
+    }
+    _length += out - field;
+}
+
+
+- (void)addDouble:(const double)value scale:(const int32_t)scale {
+    const double scaled = round(value * pow(10.0, scale));
+    if (!(scaled >= (double)INT64_MIN && scaled < (double)INT64_MAX)) {
+        [NSException raise:NSInvalidArgumentException format:@"%f does not fit at scale %d", value, scale];
+    }
+    [self addUnscaledDecimal:(int64_t)scaled scale:scale];
+}
+
+
+- (void)reset {
+    _length = 0;
+    _recordHasFields = NO;
+}
+
+
+- (PTDiffusionRecordV2 *)build {
+    return [[PTDiffusionRecordV2 alloc] initWithData:[NSData dataWithBytes:_bytes length:_length]];
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  RecordV2BatchValidator.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "RecordV2Accessor.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The outcome for one (old, new) pair.
+ */
+@interface RecordV2BatchResult : NSObject
+
+/**
+ Set if the new value does not conform to the schema, in which case there is
+ no delta.
+ */
+@property (nonatomic, readonly, nullable) NSError *error;
+
+/**
+ The delta from the old value to the new, or `nil` if they are equal or the new
+ value is invalid.
+ */
+@property (nonatomic, readonly, nullable) PTDiffusionRecordV2Delta *delta;
+
+/**
+ The fields that differ between the values, including fields only one of them
+ has, packed as an array of RecordV2FieldHandle.
+ */
+@property (nonatomic, readonly) NSData *changedFields;
+
+@end
+
+
+/**
+ Validates and diffs many RecordV2 values of one schema, as when publishing a
+ board of records.
+
+ The schema is compiled once into a table of record and field multiplicities
+ and types. Each value is then checked by a single pass over its bytes, and
+ each pair is diffed by walking both values side by side; no model is built
+ for either. Only a value the fast check rejects is passed to
+ PTDiffusionRecordV2#validatedModelWithSchema:error:, which remains the
+ authority and supplies the error.
+
+ Instances are immutable and can be shared between threads.
+ */
+@interface RecordV2BatchValidator : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSchema:(PTDiffusionRecordV2Schema *)schema NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) PTDiffusionRecordV2Schema *schema;
+
+- (BOOL)validateRecord:(PTDiffusionRecordV2 *)record error:(NSError **)error;
+
+/**
+ Validates each new value and diffs it against the old value at the same
+ index. Old values are assumed to have been validated when they were
+ published.
+
+ @param concurrent Whether to spread the pairs across cores. Worthwhile for
+ large batches.
+ @return One result per pair, in order.
+ @exception NSInvalidArgumentException If the arrays differ in length.
+ */
+- (NSArray<RecordV2BatchResult *> *)processOldRecords:(NSArray<PTDiffusionRecordV2 *> *)oldRecords
+                                           newRecords:(NSArray<PTDiffusionRecordV2 *> *)newRecords
+                                           concurrent:(BOOL)concurrent;
+
+@end
+
+NS_ASSUME_NONNULL_END
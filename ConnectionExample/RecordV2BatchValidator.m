@@ -0,0 +1,285 @@
+//
+//  RecordV2BatchValidator.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RecordV2BatchValidator.h"
+
+
+typedef struct {
+    SInt32 min;
+    SInt32 max;
+    uint32_t firstField;
+    uint32_t fieldCount;
+} _Record;
+
+
+typedef struct {
+    SInt32 min;
+    SInt32 max;
+    RecordV2FieldType type;
+    int32_t scale;
+} _Field;
+
+
+/**
+ Moves to the next occurrence of a node, or to the next node once a fixed one
+ has occurred max times.
+
+ @return `NO` if the last node would exceed its maximum.
+ */
+static BOOL _Advance(uint32_t *const node, uint32_t *const occurrence, const SInt32 max, const BOOL isLast) {
+    if (!isLast && max >= 0 && (SInt64)*occurrence + 1 >= max) {
+        ++*node;
+        *occurrence = 0;
+        return YES;
+    }
+    ++*occurrence;
+    return max < 0 || (SInt64)*occurrence < max;
+}
+
+
+static BOOL _IsValidField(const _Field *const field, const RecordV2FieldSlice slice) {
+    int64_t ignored;
+    switch (field->type) {
+        case RecordV2FieldType_String:
+            return YES;
+        case RecordV2FieldType_Integer:
+            return [RecordV2Accessor parseInt64:&ignored fromSlice:slice];
+        case RecordV2FieldType_Decimal:
+            return [RecordV2Accessor parseUnscaledDecimal:&ignored scale:field->scale fromSlice:slice];
+    }
+    return NO;
+}
+
+
+@interface RecordV2BatchResult ()
+@property (nonatomic, readwrite, nullable) NSError *error;
+@property (nonatomic, readwrite, nullable) PTDiffusionRecordV2Delta *delta;
+@property (nonatomic, readwrite) NSData *changedFields;
+@end
+
+
+@implementation RecordV2BatchResult
+@end
+
+
+@implementation RecordV2BatchValidator {
+    _Record *_records;
+    uint32_t _recordCount;
+    _Field *_fields;
+}
+
+
+- (instancetype)initWithSchema:(PTDiffusionRecordV2Schema *const)schema {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _schema = schema;
+
+    NSArray<PTDiffusionRecordV2SchemaRecord *> *const records = schema.records;
+    NSUInteger fieldCount = 0;
+    for (PTDiffusionRecordV2SchemaRecord *const record in records) {
+        fieldCount += record.fields.count;
+    }
+    _recordCount = (uint32_t)records.count;
+    _records = calloc(MAX(_recordCount, 1u), sizeof(_Record));
+    _fields = calloc(MAX(fieldCount, (NSUInteger)1), sizeof(_Field));
+    if (!_records || !_fields) {
+        [NSException raise:NSMallocException format:@"Unable to compile schema"];
+    }
+
+    uint32_t f = 0;
+    for (uint32_t r = 0; r < _recordCount; ++r) {
+        PTDiffusionRecordV2SchemaRecord *const record = records[r];
+        _records[r].min = record.min;
+        _records[r].max = record.max;
+        _records[r].firstField = f;
+        _records[r].fieldCount = (uint32_t)record.fields.count;
+        for (PTDiffusionRecordV2SchemaField *const field in record.fields) {
+            _fields[f].min = field.min;
+            _fields[f].max = field.max;
+            _fields[f].type = [RecordV2Accessor fieldTypeOfSchemaField:field];
+            _fields[f].scale = field.scale;
+            ++f;
+        }
+    }
+    return self;
+}
+
+
+- (void)dealloc {
+    free(_records);
+    free(_fields);
+}
+
+
+/**
+ Checks a value against the compiled schema in one pass over its bytes.
+
+ Answers `NO` for anything it is not certain of, such as an empty value or a
+ last node with no occurrences, leaving those to the client library.
+ */
+- (BOOL)quicklyValidateRecord:(PTDiffusionRecordV2 *const)record {
+    NSData *const data = record.data;
+    RecordV2FieldCursor cursor = RecordV2FieldCursorMake(data);
+    if (!cursor.bytes || 0 == _recordCount) {
+        return NO;
+    }
+
+    uint32_t r = 0;
+    uint32_t recordOccurrence = 0;
+    uint32_t f = _records[0].firstField;
+    uint32_t fieldOccurrence = 0;
+    uint32_t ignoredRecord, ignoredField;
+    RecordV2FieldSlice slice;
+    BOOL endsRecord;
+    while (RecordV2FieldCursorNext(&cursor, &ignoredRecord, &ignoredField, &slice, &endsRecord)) {
+        const _Record *const schemaRecord = &_records[r];
+        const uint32_t lastField = schemaRecord->firstField + schemaRecord->fieldCount - 1;
+        if (0 == schemaRecord->fieldCount || !_IsValidField(&_fields[f], slice)) {
+            return NO;
+        }
+        if (!endsRecord) {
+            if (!_Advance(&f, &fieldOccurrence, _fields[f].max, f == lastField)) {
+                return NO;
+            }
+            continue;
+        }
+
+        if (f != lastField || (SInt64)fieldOccurrence + 1 < _fields[f].min) {
+            return NO;
+        }
+        if (!cursor.bytes) {
+            return r == _recordCount - 1 && (SInt64)recordOccurrence + 1 >= schemaRecord->min;
+        }
+        if (!_Advance(&r, &recordOccurrence, schemaRecord->max, r == _recordCount - 1)) {
+            return NO;
+        }
+        f = _records[r].firstField;
+        fieldOccurrence = 0;
+    }
+    return NO;
+}
+
+
+- (BOOL)validateRecord:(PTDiffusionRecordV2 *const)record error:(NSError **const)error {
+    if ([self quicklyValidateRecord:record]) {
+        return YES;
+    }
+    return nil != [record validatedModelWithSchema:_schema error:error];
+}
+
+
+/**
+ Resolves a position in a value to a handle. Only the last node at each level
+ varies, so earlier ones always occur max times.
+ */
+- (RecordV2FieldHandle)handleForRecord:(const uint32_t)recordPosition field:(const uint32_t)fieldPosition {
+    uint32_t r = 0;
+    for (uint32_t remaining = recordPosition; r + 1 < _recordCount && _records[r].max >= 0 && remaining >= (uint32_t)_records[r].max; ++r) {
+        remaining -= _records[r].max;
+    }
+    const _Record *const record = &_records[r];
+    uint32_t f = record->firstField;
+    const uint32_t lastField = record->firstField + record->fieldCount - 1;
+    for (uint32_t remaining = fieldPosition; f < lastField && _fields[f].max >= 0 && remaining >= (uint32_t)_fields[f].max; ++f) {
+        remaining -= _fields[f].max;
+    }
+
+    RecordV2FieldHandle handle = {0};
+    handle.record = recordPosition;
+    handle.field = fieldPosition;
+    handle.type = _fields[f].type;
+    handle.scale = _fields[f].scale;
+    return handle;
+}
+
+
+- (void)appendChangedFieldsFromRecord:(PTDiffusionRecordV2 *const)oldRecord
+                             toRecord:(PTDiffusionRecordV2 *const)newRecord
+                               toData:(NSMutableData *const)changed {
+    NSData *const oldData = oldRecord.data;
+    NSData *const newData = newRecord.data;
+    RecordV2FieldCursor oldCursor = RecordV2FieldCursorMake(oldData);
+    RecordV2FieldCursor newCursor = RecordV2FieldCursorMake(newData);
+
+    uint32_t oldR, oldF, newR, newF;
+    RecordV2FieldSlice oldSlice, newSlice;
+    BOOL ignored;
+    BOOL haveOld = RecordV2FieldCursorNext(&oldCursor, &oldR, &oldF, &oldSlice, &ignored);
+    BOOL haveNew = RecordV2FieldCursorNext(&newCursor, &newR, &newF, &newSlice, &ignored);
+    while (haveOld || haveNew) {
+        const BOOL samePosition = haveOld && haveNew && oldR == newR && oldF == newF;
+        if (samePosition) {
+            if (oldSlice.length != newSlice.length || 0 != memcmp(oldSlice.bytes, newSlice.bytes, newSlice.length)) {
+                const RecordV2FieldHandle handle = [self handleForRecord:newR field:newF];
+                [changed appendBytes:&handle length:sizeof(handle)];
+            }
+            haveOld = RecordV2FieldCursorNext(&oldCursor, &oldR, &oldF, &oldSlice, &ignored);
+            haveNew = RecordV2FieldCursorNext(&newCursor, &newR, &newF, &newSlice, &ignored);
+        } else if (haveOld && (!haveNew || oldR < newR || (oldR == newR && oldF < newF))) {
+            const RecordV2FieldHandle handle = [self handleForRecord:oldR field:oldF];
+            [changed appendBytes:&handle length:sizeof(handle)];
+            haveOld = RecordV2FieldCursorNext(&oldCursor, &oldR, &oldF, &oldSlice, &ignored);
+        } else {
+            const RecordV2FieldHandle handle = [self handleForRecord:newR field:newF];
+            [changed appendBytes:&handle length:sizeof(handle)];
+            haveNew = RecordV2FieldCursorNext(&newCursor, &newR, &newF, &newSlice, &ignored);
+        }
+    }
+}
+
+
+- (void)processOldRecord:(PTDiffusionRecordV2 *const)oldRecord
+               newRecord:(PTDiffusionRecordV2 *const)newRecord
+                  result:(RecordV2BatchResult *const)result {
+    NSError *error = nil;
+    if (![self validateRecord:newRecord error:&error]) {
+        result.error = error;
+        result.changedFields = [NSData data];
+        return;
+    }
+    NSMutableData *const changed = [NSMutableData new];
+    [self appendChangedFieldsFromRecord:oldRecord toRecord:newRecord toData:changed];
+    result.changedFields = changed;
+    if (changed.length > 0) {
+        result.delta = [newRecord diffFromOriginalRecord:oldRecord];
+    }
+}
+
+
+- (NSArray<RecordV2BatchResult *> *)processOldRecords:(NSArray<PTDiffusionRecordV2 *> *const)oldRecords
+                                           newRecords:(NSArray<PTDiffusionRecordV2 *> *const)newRecords
+                                           concurrent:(const BOOL)concurrent {
+    const NSUInteger count = newRecords.count;
+    if (oldRecords.count != count) {
+        [NSException raise:NSInvalidArgumentException
+                    format:@"%lu old records for %lu new records", (unsigned long)oldRecords.count, (unsigned long)count];
+    }
+
+    // Results are created up front so that concurrent iterations only write
+    // to their own result.
+    NSMutableArray<RecordV2BatchResult *> *const results = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [results addObject:[RecordV2BatchResult new]];
+    }
+
+    void (^const process)(size_t) = ^(const size_t i) {
+        @autoreleasepool {
+            [self processOldRecord:oldRecords[i] newRecord:newRecords[i] result:results[i]];
+        }
+    };
+    if (concurrent) {
+        dispatch_apply(count, DISPATCH_APPLY_AUTO, process);
+    } else {
+        for (NSUInteger i = 0; i < count; ++i) {
+            process(i);
+        }
+    }
+    return results;
+}
+
+@end
@@ -0,0 +1,79 @@
+//
+//  RecordV2SchemaCache.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, RecordV2SchemaValidation) {
+    /**
+     Every value is parsed with PTDiffusionRecordV2#validatedModelWithSchema:error:
+     */
+    RecordV2SchemaValidation_Always,
+
+    /**
+     The first value parsed against a schema is validated; later values of the
+     same schema are parsed with PTDiffusionRecordV2#modelWithSchema:error:,
+     relying on the server having validated them on entry.
+     */
+    RecordV2SchemaValidation_FirstValue,
+
+    RecordV2SchemaValidation_Never,
+};
+
+/**
+ Parses each distinct RecordV2 schema once and shares the resulting
+ PTDiffusionRecordV2Schema, which is immutable, between every topic that uses
+ it.
+
+ Schemas are keyed by their JSON bytes, so topics whose specifications carry
+ the same schema share an instance however the specifications were obtained.
+
+ Instances are safe to use from any thread.
+ */
+@interface RecordV2SchemaCache : NSObject
+
+/**
+ The cache attached to a session, created on first use.
+ */
++ (instancetype)cacheForSession:(PTDiffusionSession *)session;
+
+/**
+ The maximum number of schemas held. Defaults to 64; 0 means no limit.
+ */
+@property (nonatomic) NSUInteger countLimit;
+
+/**
+ Defaults to RecordV2SchemaValidation_Always. The other values trust the
+ server to have validated what it sends and must be chosen explicitly.
+ */
+@property (atomic) RecordV2SchemaValidation validation;
+
+- (nullable PTDiffusionRecordV2Schema *)schemaWithJSONData:(NSData *)data error:(NSError **)error;
+
+/**
+ The schema named by PTDiffusionTopicSpecification#schemaPropertyKey, or `nil`
+ with no error if the specification has none.
+ */
+- (nullable PTDiffusionRecordV2Schema *)schemaForSpecification:(PTDiffusionTopicSpecification *)specification
+                                                         error:(NSError **)error;
+
+/**
+ Parses a value, validating it according to the validation property. The
+ schema should have been obtained from the receiver.
+ */
+- (nullable PTDiffusionRecordV2Model *)modelForRecord:(PTDiffusionRecordV2 *)record
+                                               schema:(PTDiffusionRecordV2Schema *)schema
+                                                error:(NSError **)error;
+
+- (void)removeAllSchemas;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,136 @@
+//
+//  RecordV2SchemaCache.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RecordV2SchemaCache.h"
+#import <objc/runtime.h>
+#import <os/lock.h>
+
+
+static const void *const _SessionCacheKey = &_SessionCacheKey;
+
+
+@implementation RecordV2SchemaCache {
+    // NSCache is thread safe and evicts under memory pressure.
+    NSCache<NSData *, PTDiffusionRecordV2Schema *> *_byData;
+    NSCache<NSString *, PTDiffusionRecordV2Schema *> *_byString;
+    os_unfair_lock _lock;
+    // Guarded by _lock. Weak, so evicted schemas drop out.
+    NSHashTable<PTDiffusionRecordV2Schema *> *_validated;
+}
+
+
++ (instancetype)cacheForSession:(PTDiffusionSession *const)session {
+    @synchronized (session) {
+        RecordV2SchemaCache *cache = objc_getAssociatedObject(session, _SessionCacheKey);
+        if (!cache) {
+            cache = [RecordV2SchemaCache new];
+            objc_setAssociatedObject(session, _SessionCacheKey, cache, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+        }
+        return cache;
+    }
+}
+
+
+- (instancetype)init {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _byData = [NSCache new];
+    _byString = [NSCache new];
+    _lock = OS_UNFAIR_LOCK_INIT;
+    _validated = [NSHashTable weakObjectsHashTable];
+    _validation = RecordV2SchemaValidation_Always;
+    self.countLimit = 64;
+    return self;
+}
+
+
+- (NSUInteger)countLimit {
+    return _byData.countLimit;
+}
+
+
+- (void)setCountLimit:(const NSUInteger)countLimit {
+    _byData.countLimit = countLimit;
+    _byString.countLimit = countLimit;
+}
+
+
+- (PTDiffusionRecordV2Schema *)schemaWithJSONData:(NSData *const)data error:(NSError **const)error {
+    PTDiffusionRecordV2Schema *schema = [_byData objectForKey:data];
+    if (!schema) {
+        NSData *const key = [data copy];
+        schema = [PTDiffusionRecordV2Schema schemaWithJSONData:key error:error];
+        if (!schema) {
+            return nil;
+        }
+        [_byData setObject:schema forKey:key];
+    }
+    return schema;
+}
+
+
+- (PTDiffusionRecordV2Schema *)schemaForSpecification:(PTDiffusionTopicSpecification *const)specification
+                                                error:(NSError **const)error {
+    NSString *const json = specification.properties[PTDiffusionTopicSpecification.schemaPropertyKey];
+    if (!json) {
+        return nil;
+    }
+    // Specifications hold the schema as a string; look that up first so the
+    // common case does not convert it to bytes.
+    PTDiffusionRecordV2Schema *schema = [_byString objectForKey:json];
+    if (!schema) {
+        schema = [self schemaWithJSONData:[json dataUsingEncoding:NSUTF8StringEncoding] error:error];
+        if (!schema) {
+            return nil;
+        }
+        [_byString setObject:schema forKey:[json copy]];
+    }
+    return schema;
+}
+
+
+- (PTDiffusionRecordV2Model *)modelForRecord:(PTDiffusionRecordV2 *const)record
+                                      schema:(PTDiffusionRecordV2Schema *const)schema
+                                       error:(NSError **const)error {
+    BOOL validate;
+    switch (self.validation) {
+        case RecordV2SchemaValidation_Always:
+            validate = YES;
+            break;
+        case RecordV2SchemaValidation_FirstValue:
+            os_unfair_lock_lock(&_lock);
+            validate = ![_validated containsObject:schema];
+            os_unfair_lock_unlock(&_lock);
+            break;
+        case RecordV2SchemaValidation_Never:
+            validate = NO;
+            break;
+    }
+    if (!validate) {
+        return [record modelWithSchema:schema error:error];
+    }
+
+    PTDiffusionRecordV2Model *const model = [record validatedModelWithSchema:schema error:error];
+    if (model) {
+        os_unfair_lock_lock(&_lock);
+        [_validated addObject:schema];
+        os_unfair_lock_unlock(&_lock);
+    }
+    return model;
+}
+
+
+- (void)removeAllSchemas {
+    [_byData removeAllObjects];
+    [_byString removeAllObjects];
+    os_unfair_lock_lock(&_lock);
+    [_validated removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
@@ -0,0 +1,87 @@
+//
+//  RequestBenchmark.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Sends one request. The completion handler must be called once, on the main
+ queue.
+ */
+typedef void (^RequestBenchmarkSender)(void (^completionHandler)(NSError * _Nullable error));
+
+@interface RequestBenchmarkResult : NSObject
+
+@property (nonatomic, readonly) NSUInteger concurrency;
+@property (nonatomic, readonly) NSUInteger requestCount;
+@property (nonatomic, readonly) NSUInteger errorCount;
+@property (nonatomic, readonly) NSTimeInterval elapsed;
+@property (nonatomic, readonly) double requestsPerSecond;
+
+/**
+ Latencies are measured from the moment a request is sent, not from when it
+ was queued waiting for a free slot.
+ */
+@property (nonatomic, readonly) NSTimeInterval p50Latency;
+@property (nonatomic, readonly) NSTimeInterval p99Latency;
+
+@end
+
+
+/**
+ Measures request throughput and latency at increasing numbers of requests in
+ flight, to find the point beyond which more concurrency only adds latency.
+
+ Each run sends requestsPerRun requests through a RequestWindow sized to the
+ concurrency level of the run. Runs happen one after the other on the main
+ queue.
+ */
+@interface RequestBenchmark : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSender:(RequestBenchmarkSender)sender NS_DESIGNATED_INITIALIZER;
+
+/**
+ Sends the given request to a path of the session, expecting a JSON response.
+ */
++ (RequestBenchmarkSender)senderWithSession:(PTDiffusionSession *)session
+                                    request:(PTDiffusionRequest *)request
+                                       path:(NSString *)path;
+
+/**
+ A local stand-in for a responder, with `workers` requests serviced at once,
+ each taking `serviceTime`. Requests beyond that wait in a queue, as they would
+ at a real responder.
+ */
++ (RequestBenchmarkSender)localResponderWithServiceTime:(NSTimeInterval)serviceTime
+                                                workers:(NSUInteger)workers;
+
+/**
+ 1, 10, 100, 1000 and 10000.
+ */
++ (NSArray<NSNumber *> *)defaultConcurrencyLevels;
+
+/**
+ The number of requests sent in each run. Defaults to 20000.
+ */
+@property (nonatomic) NSUInteger requestsPerRun;
+
+/**
+ Must be called on the main queue; the completion handler is called on the
+ main queue with one result per level.
+ */
+- (void)runWithConcurrencyLevels:(NSArray<NSNumber *> *)levels
+               completionHandler:(void (^)(NSArray<RequestBenchmarkResult *> *results))completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
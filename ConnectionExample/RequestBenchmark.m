@@ -0,0 +1,225 @@
+//
+//  RequestBenchmark.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RequestBenchmark.h"
+#import "RequestWindow.h"
+
+
+static int _CompareUInt64(const void *const a, const void *const b) {
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+
+static NSTimeInterval _Percentile(const uint64_t *const sortedNanoseconds, const NSUInteger count, const double percentile) {
+    if (0 == count) {
+        return 0;
+    }
+    const NSUInteger index = MIN((NSUInteger)(percentile * count), count - 1);
+    return sortedNanoseconds[index] / (double)NSEC_PER_SEC;
+}
+
+
+@interface RequestBenchmarkResult ()
+
+@property (nonatomic, readwrite) NSUInteger concurrency;
+@property (nonatomic, readwrite) NSUInteger requestCount;
+@property (nonatomic, readwrite) NSUInteger errorCount;
+@property (nonatomic, readwrite) NSTimeInterval elapsed;
+@property (nonatomic, readwrite) NSTimeInterval p50Latency;
+@property (nonatomic, readwrite) NSTimeInterval p99Latency;
+
+@end
+
+@implementation RequestBenchmarkResult
+
+- (double)requestsPerSecond {
+    return _elapsed > 0 ? _requestCount / _elapsed : 0;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"concurrency=%lu requests=%lu errors=%lu rate=%.0f/s p50=%.3fms p99=%.3fms",
+            (unsigned long)_concurrency, (unsigned long)_requestCount, (unsigned long)_errorCount,
+            self.requestsPerSecond, _p50Latency * 1000.0, _p99Latency * 1000.0];
+}
+
+@end
+
+
+/**
+ Services requests with a fixed number of workers and a fixed service time.
+ All state is confined to a private serial queue.
+ */
+@interface RequestBenchmarkLocalResponder : NSObject
+
+- (instancetype)initWithServiceTime:(NSTimeInterval)serviceTime workers:(NSUInteger)workers;
+
+- (void)receiveRequestWithCompletionHandler:(void (^)(NSError * _Nullable error))completionHandler;
+
+@end
+
+@implementation RequestBenchmarkLocalResponder {
+    dispatch_queue_t _queue;
+    int64_t _serviceNanoseconds;
+    NSUInteger _workers;
+    NSUInteger _busy;
+    NSMutableArray<dispatch_block_t> *_waiting;
+}
+
+- (instancetype)initWithServiceTime:(const NSTimeInterval)serviceTime workers:(const NSUInteger)workers {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _queue = dispatch_queue_create("RequestBenchmark.responder", DISPATCH_QUEUE_SERIAL);
+    _serviceNanoseconds = (int64_t)(serviceTime * NSEC_PER_SEC);
+    _workers = MAX(workers, (NSUInteger)1);
+    _waiting = [NSMutableArray new];
+    return self;
+}
+
+- (void)receiveRequestWithCompletionHandler:(void (^const)(NSError *))completionHandler {
+    const dispatch_block_t respond = ^{
+        completionHandler(nil);
+    };
+    dispatch_async(_queue, ^{
+        if (self->_busy < self->_workers) {
+            [self service:respond];
+        } else {
+            [self->_waiting addObject:respond];
+        }
+    });
+}
+
+- (void)service:(const dispatch_block_t)respond {
+    ++_busy;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, _serviceNanoseconds), _queue, ^{
+        --self->_busy;
+        dispatch_async(dispatch_get_main_queue(), respond);
+        if (self->_waiting.count > 0) {
+            const dispatch_block_t next = self->_waiting.firstObject;
+            [self->_waiting removeObjectAtIndex:0];
+            [self service:next];
+        }
+    });
+}
+
+@end
+
+
+@implementation RequestBenchmark {
+    RequestBenchmarkSender _sender;
+    RequestWindow *_window;
+}
+
+
+- (instancetype)initWithSender:(const RequestBenchmarkSender)sender {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _sender = [sender copy];
+    _requestsPerRun = 20000;
+    return self;
+}
+
+
++ (RequestBenchmarkSender)senderWithSession:(PTDiffusionSession *const)session
+                                    request:(PTDiffusionRequest *const)request
+                                       path:(NSString *const)path {
+    return ^(void (^const completionHandler)(NSError *)) {
+        [session.messaging sendRequest:request toPath:path JSONCompletionHandler:^(PTDiffusionJSON *const json, NSError *const error) {
+            completionHandler(error);
+        }];
+    };
+}
+
+
++ (RequestBenchmarkSender)localResponderWithServiceTime:(const NSTimeInterval)serviceTime
+                                                workers:(const NSUInteger)workers {
+    RequestBenchmarkLocalResponder *const responder =
+        [[RequestBenchmarkLocalResponder alloc] initWithServiceTime:serviceTime workers:workers];
+    return ^(void (^const completionHandler)(NSError *)) {
+        [responder receiveRequestWithCompletionHandler:completionHandler];
+    };
+}
+
+
++ (NSArray<NSNumber *> *)defaultConcurrencyLevels {
+    return @[@1, @10, @100, @1000, @10000];
+}
+
+
+- (void)runWithConcurrencyLevels:(NSArray<NSNumber *> *const)levels
+               completionHandler:(void (^const)(NSArray<RequestBenchmarkResult *> *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Benchmarks run on the main queue");
+    NSMutableArray<RequestBenchmarkResult *> *const results = [NSMutableArray new];
+    [self runLevels:[levels copy] index:0 results:results completionHandler:completionHandler];
+}
+
+
+- (void)runLevels:(NSArray<NSNumber *> *const)levels
+            index:(const NSUInteger)index
+          results:(NSMutableArray<RequestBenchmarkResult *> *const)results
+completionHandler:(void (^const)(NSArray<RequestBenchmarkResult *> *))completionHandler {
+    if (index == levels.count) {
+        completionHandler(results);
+        return;
+    }
+    [self runWithConcurrency:levels[index].unsignedIntegerValue completionHandler:^(RequestBenchmarkResult *const result) {
+        [results addObject:result];
+        [self runLevels:levels index:index + 1 results:results completionHandler:completionHandler];
+    }];
+}
+
+
+- (void)runWithConcurrency:(const NSUInteger)concurrency
+         completionHandler:(void (^const)(RequestBenchmarkResult *))completionHandler {
+    const NSUInteger count = _requestsPerRun;
+    NSParameterAssert(count > 0);
+    RequestWindow *const window = [[RequestWindow alloc] initWithSession:nil maximumOutstandingRequests:concurrency];
+    _window = window;
+    const RequestBenchmarkSender sender = _sender;
+
+    // Latencies go into a plain buffer so that recording them does not
+    // allocate on the measured path.
+    NSMutableData *const latencies = [NSMutableData dataWithLength:count * sizeof(uint64_t)];
+    __block NSUInteger completed = 0;
+    __block NSUInteger errors = 0;
+    const uint64_t runStart = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+    for (NSUInteger i = 0; i < count; ++i) {
+        [window performOperation:^(const dispatch_block_t done) {
+            const uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            sender(^(NSError *const error) {
+                uint64_t *const latencyBuffer = latencies.mutableBytes;
+                latencyBuffer[completed++] = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+                if (error) {
+                    ++errors;
+                }
+                const BOOL last = completed == count;
+                done();
+                if (!last) {
+                    return;
+                }
+                const uint64_t runEnd = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+                qsort(latencyBuffer, count, sizeof(uint64_t), _CompareUInt64);
+
+                RequestBenchmarkResult *const result = [RequestBenchmarkResult new];
+                result.concurrency = concurrency;
+                result.requestCount = count;
+                result.errorCount = errors;
+                result.elapsed = (runEnd - runStart) / (double)NSEC_PER_SEC;
+                result.p50Latency = _Percentile(latencyBuffer, count, 0.50);
+                result.p99Latency = _Percentile(latencyBuffer, count, 0.99);
+                self->_window = nil;
+                completionHandler(result);
+            });
+        }];
+    }
+}
+
+@end
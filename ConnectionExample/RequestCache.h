@@ -0,0 +1,63 @@
+//
+//  RequestCache.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Builds JSON requests once and shares them between sends.
+
+ A PTDiffusionRequest is immutable and holds its value in the CBOR form that is
+ written to the wire, so one instance can be sent any number of times, to any
+ number of paths or sessions, without encoding the value again. The cache maps
+ CBOR bytes to the request built from them; building from bytes that are
+ already CBOR skips the object to CBOR encoding step entirely.
+
+ Instances are safe to use from any thread.
+ */
+@interface RequestCache : NSObject
+
+/**
+ Creates a request directly from CBOR encoded bytes, without decoding or
+ re-encoding them. The bytes must be a single well-formed CBOR data item.
+ */
++ (PTDiffusionRequest *)requestWithCBORData:(NSData *)data;
+
+/**
+ The maximum number of requests held. Defaults to 256; 0 means no limit.
+ */
+@property (nonatomic) NSUInteger countLimit;
+
+/**
+ Returns the shared request for the given CBOR bytes, building it if needed.
+ */
+- (PTDiffusionRequest *)requestWithCBORData:(NSData *)data;
+
+/**
+ Returns the shared request for the given JSON value, building it if needed.
+ */
+- (PTDiffusionRequest *)requestWithJSON:(PTDiffusionJSON *)json;
+
+/**
+ Encodes the object to CBOR once, on first use of the key, and returns the
+ shared request for it thereafter. Use this for request bodies that are built
+ from Foundation objects and reused unchanged, such as a fixed query.
+
+ @return The request, or `nil` if the object could not be encoded.
+ */
+- (nullable PTDiffusionRequest *)requestForKey:(id<NSCopying>)key
+                                        object:(id)object
+                                         error:(NSError **)error;
+
+- (void)removeAllRequests;
+
+@end
+
+NS_ASSUME_NONNULL_END
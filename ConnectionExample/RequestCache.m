@@ -0,0 +1,90 @@
+//
+//  RequestCache.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RequestCache.h"
+
+
+@implementation RequestCache {
+    // NSCache is thread safe and evicts under memory pressure.
+    NSCache<NSData *, PTDiffusionRequest *> *_byData;
+    NSCache<id, PTDiffusionRequest *> *_byKey;
+}
+
+
++ (PTDiffusionRequest *)requestWithCBORData:(NSData *const)data {
+    return [[PTDiffusionJSON alloc] initWithData:data].request;
+}
+
+
+- (instancetype)init {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _byData = [NSCache new];
+    _byKey = [NSCache new];
+    self.countLimit = 256;
+    return self;
+}
+
+
+- (NSUInteger)countLimit {
+    return _byData.countLimit;
+}
+
+
+- (void)setCountLimit:(const NSUInteger)countLimit {
+    _byData.countLimit = countLimit;
+    _byKey.countLimit = countLimit;
+}
+
+
+- (PTDiffusionRequest *)requestWithCBORData:(NSData *const)data {
+    PTDiffusionRequest *request = [_byData objectForKey:data];
+    if (!request) {
+        NSData *const key = [data copy];
+        request = [RequestCache requestWithCBORData:key];
+        [_byData setObject:request forKey:key];
+    }
+    return request;
+}
+
+
+- (PTDiffusionRequest *)requestWithJSON:(PTDiffusionJSON *const)json {
+    NSData *const data = json.data;
+    PTDiffusionRequest *request = [_byData objectForKey:data];
+    if (!request) {
+        request = json.request;
+        [_byData setObject:request forKey:data];
+    }
+    return request;
+}
+
+
+- (PTDiffusionRequest *)requestForKey:(const id<NSCopying>)key
+                               object:(const id)object
+                                error:(NSError **const)error {
+    PTDiffusionRequest *request = [_byKey objectForKey:key];
+    if (request) {
+        return request;
+    }
+    PTDiffusionJSON *const json = [[PTDiffusionJSON alloc] initWithObject:object error:error];
+    if (!json) {
+        return nil;
+    }
+    request = [self requestWithJSON:json];
+    // NSCache does not copy its keys.
+    [_byKey setObject:request forKey:[key copyWithZone:nil]];
+    return request;
+}
+
+
+- (void)removeAllRequests {
+    [_byData removeAllObjects];
+    [_byKey removeAllObjects];
+}
+
+@end
@@ -0,0 +1,75 @@
+//
+//  RequestWindow.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An operation run by a RequestWindow. It must call `done` exactly once, on the
+ main queue, when the request it sends has completed.
+ */
+typedef void (^RequestWindowOperation)(dispatch_block_t done);
+
+/**
+ Limits the number of requests a session has outstanding at once.
+
+ Every request sent through a session is queued by the client library until
+ the server has taken it, and the session is closed if that queue exceeds
+ PTDiffusionSessionConfiguration#maximumQueueSize. Sending through a window
+ holds back requests beyond maximumOutstandingRequests in a local queue, so a
+ burst of sends can be pipelined up to the limit without overrunning the
+ session.
+
+ Instances are confined to the main queue.
+ */
+@interface RequestWindow : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSession:(nullable PTDiffusionSession *)session
+     maximumOutstandingRequests:(NSUInteger)maximumOutstandingRequests NS_DESIGNATED_INITIALIZER;
+
+/**
+ A window sized to half the maximum queue size of the session's configuration,
+ leaving room for topic updates and other traffic.
+ */
++ (instancetype)windowWithSession:(PTDiffusionSession *)session;
+
+@property (nonatomic, readonly, nullable) PTDiffusionSession *session;
+
+/**
+ The maximum number of operations running at once. May be changed at any time;
+ raising it starts queued operations immediately.
+ */
+@property (nonatomic) NSUInteger maximumOutstandingRequests;
+
+@property (nonatomic, readonly) NSUInteger outstandingRequests;
+
+/**
+ The number of operations waiting for a free slot.
+ */
+@property (nonatomic, readonly) NSUInteger queuedRequests;
+
+/**
+ Runs the operation now if a slot is free, otherwise once one is.
+ */
+- (void)performOperation:(RequestWindowOperation)operation;
+
+/**
+ Sends a request expecting a JSON response through the window.
+ */
+- (void)       sendRequest:(PTDiffusionRequest *)request
+                    toPath:(NSString *)path
+     JSONCompletionHandler:(void (^)(PTDiffusionJSON * _Nullable json, NSError * _Nullable error))completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
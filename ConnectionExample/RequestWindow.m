@@ -0,0 +1,98 @@
+//
+//  RequestWindow.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "RequestWindow.h"
+
+
+@implementation RequestWindow {
+    // NSMutableArray removes from the front in constant time.
+    NSMutableArray<RequestWindowOperation> *_queue;
+    BOOL _draining;
+}
+
+
+- (instancetype)initWithSession:(PTDiffusionSession *const)session
+     maximumOutstandingRequests:(const NSUInteger)maximumOutstandingRequests {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    if (0 == maximumOutstandingRequests) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one request must be allowed"];
+    }
+    _session = session;
+    _maximumOutstandingRequests = maximumOutstandingRequests;
+    _queue = [NSMutableArray new];
+    return self;
+}
+
+
++ (instancetype)windowWithSession:(PTDiffusionSession *const)session {
+    const NSUInteger maximumQueueSize = session.configuration.maximumQueueSize;
+    return [[self alloc] initWithSession:session
+              maximumOutstandingRequests:MAX(maximumQueueSize / 2, (NSUInteger)1)];
+}
+
+
+- (void)setMaximumOutstandingRequests:(const NSUInteger)maximumOutstandingRequests {
+    if (0 == maximumOutstandingRequests) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one request must be allowed"];
+    }
+    _maximumOutstandingRequests = maximumOutstandingRequests;
+    [self drain];
+}
+
+
+- (NSUInteger)queuedRequests {
+    return _queue.count;
+}
+
+
+- (void)performOperation:(const RequestWindowOperation)operation {
+    NSAssert(NSThread.isMainThread, @"Request windows are confined to the main queue");
+    [_queue addObject:[operation copy]];
+    [self drain];
+}
+
+
+- (void)drain {
+    // Operations may complete synchronously; keep that iterative.
+    if (_draining) {
+        return;
+    }
+    _draining = YES;
+    while (_outstandingRequests < _maximumOutstandingRequests && _queue.count > 0) {
+        const RequestWindowOperation operation = _queue.firstObject;
+        [_queue removeObjectAtIndex:0];
+        ++_outstandingRequests;
+        __block BOOL completed = NO;
+        operation(^{
+            NSCAssert(!completed, @"Request operation completed more than once");
+            completed = YES;
+            --self->_outstandingRequests;
+            [self drain];
+        });
+    }
+    _draining = NO;
+}
+
+
+- (void)       sendRequest:(PTDiffusionRequest *const)request
+                    toPath:(NSString *const)path
+     JSONCompletionHandler:(void (^const)(PTDiffusionJSON *, NSError *))completionHandler {
+    PTDiffusionSession *const session = _session;
+    if (!session) {
+        [NSException raise:NSInternalInconsistencyException format:@"Window has no session"];
+    }
+    [self performOperation:^(const dispatch_block_t done) {
+        [session.messaging sendRequest:request toPath:path JSONCompletionHandler:^(PTDiffusionJSON *const json, NSError *const error) {
+            done();
+            completionHandler(json, error);
+        }];
+    }];
+}
+
+@end
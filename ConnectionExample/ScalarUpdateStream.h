@@ -0,0 +1,94 @@
+//
+//  ScalarUpdateStream.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Passes a value, or `nil` for null, on to the client library, with the
+ semantics of PTDiffusionNumberUpdateStream#setValue:completionHandler:error:
+ */
+typedef BOOL (^ScalarUpdateSink)(NSNumber * _Nullable value,
+    void (^completionHandler)(PTDiffusionTopicCreationResult * _Nullable result, NSError * _Nullable error),
+    NSError **error);
+
+/**
+ Sets a numeric topic from C scalars, for publishers that hold prices and
+ counts as int64_t or double rather than NSNumber.
+
+ The client library's update streams only accept NSNumber, so the value is
+ boxed once at that boundary. The box of the last value set is kept and passed
+ again when a value repeats, which is common for prices that tick without
+ moving, and the current value is read back without unboxing. The library
+ has no scalar encoding path, so every new value is still boxed.
+
+ Instances are confined to the main queue.
+ */
+@interface ScalarUpdateStream : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSink:(ScalarUpdateSink)sink NS_DESIGNATED_INITIALIZER;
+
+/**
+ Sets an int64 topic through
+ PTDiffusionTopicUpdateFeature#int64NumberUpdateStreamWithPath:
+ */
++ (instancetype)int64StreamWithSession:(PTDiffusionSession *)session path:(NSString *)path;
+
+/**
+ Sets a double topic through
+ PTDiffusionTopicUpdateFeature#doubleFloatNumberUpdateStreamWithPath:
+ */
++ (instancetype)doubleStreamWithSession:(PTDiffusionSession *)session path:(NSString *)path;
+
+/**
+ A sink that completes every set immediately with no result, for testing
+ without a session.
+ */
++ (ScalarUpdateSink)localSink;
+
+- (BOOL)setInt64:(int64_t)value
+    completionHandler:(void (^)(PTDiffusionTopicCreationResult * _Nullable result, NSError * _Nullable error))completionHandler
+                error:(NSError **)error;
+
+- (BOOL)setDouble:(double)value
+    completionHandler:(void (^)(PTDiffusionTopicCreationResult * _Nullable result, NSError * _Nullable error))completionHandler
+                error:(NSError **)error;
+
+- (BOOL)setNullWithCompletionHandler:(void (^)(PTDiffusionTopicCreationResult * _Nullable result, NSError * _Nullable error))completionHandler
+                               error:(NSError **)error;
+
+/**
+ `NO` until a value has been set, and after null is set.
+ */
+@property (nonatomic, readonly) BOOL hasValue;
+
+/**
+ The last value set with setInt64:completionHandler:error:, or zero if the
+ last value was set otherwise.
+ */
+@property (nonatomic, readonly) int64_t int64Value;
+
+/**
+ The last value set with setDouble:completionHandler:error:, or zero if the
+ last value was set otherwise.
+ */
+@property (nonatomic, readonly) double doubleValue;
+
+/**
+ Sets that passed the previous value's box again.
+ */
+@property (nonatomic, readonly) NSUInteger reusedCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
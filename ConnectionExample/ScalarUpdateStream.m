@@ -0,0 +1,100 @@
+//
+//  ScalarUpdateStream.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ScalarUpdateStream.h"
+
+
+@implementation ScalarUpdateStream {
+    ScalarUpdateSink _sink;
+    NSNumber *_box;
+    BOOL _boxIsDouble;
+}
+
+
+- (instancetype)initWithSink:(const ScalarUpdateSink)sink {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _sink = [sink copy];
+    return self;
+}
+
+
++ (instancetype)int64StreamWithSession:(PTDiffusionSession *const)session path:(NSString *const)path {
+    PTDiffusionNumberUpdateStream *const stream = [session.topicUpdate int64NumberUpdateStreamWithPath:path];
+    return [[self alloc] initWithSink:^BOOL(NSNumber *const value, void (^const completionHandler)(PTDiffusionTopicCreationResult *, NSError *), NSError **const error) {
+        return [stream setValue:value completionHandler:completionHandler error:error];
+    }];
+}
+
+
++ (instancetype)doubleStreamWithSession:(PTDiffusionSession *const)session path:(NSString *const)path {
+    PTDiffusionNumberUpdateStream *const stream = [session.topicUpdate doubleFloatNumberUpdateStreamWithPath:path];
+    return [[self alloc] initWithSink:^BOOL(NSNumber *const value, void (^const completionHandler)(PTDiffusionTopicCreationResult *, NSError *), NSError **const error) {
+        return [stream setValue:value completionHandler:completionHandler error:error];
+    }];
+}
+
+
++ (ScalarUpdateSink)localSink {
+    return ^BOOL(NSNumber *const value,
+                 void (^const completionHandler)(PTDiffusionTopicCreationResult *, NSError *),
+                 NSError **const error) {
+        completionHandler(nil, nil);
+        return YES;
+    };
+}
+
+
+- (BOOL)setInt64:(const int64_t)value
+    completionHandler:(void (^const)(PTDiffusionTopicCreationResult *, NSError *))completionHandler
+                error:(NSError **const)error {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    if (_box && !_boxIsDouble && _int64Value == value) {
+        ++_reusedCount;
+    } else {
+        _box = [NSNumber numberWithLongLong:value];
+        _boxIsDouble = NO;
+        _int64Value = value;
+        _doubleValue = 0;
+    }
+    return _sink(_box, completionHandler, error);
+}
+
+
+- (BOOL)setDouble:(const double)value
+    completionHandler:(void (^const)(PTDiffusionTopicCreationResult *, NSError *))completionHandler
+                error:(NSError **const)error {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    // Compared bitwise so that -0.0 and NaN payloads are passed on as given.
+    if (_box && _boxIsDouble && 0 == memcmp(&_doubleValue, &value, sizeof(value))) {
+        ++_reusedCount;
+    } else {
+        _box = [NSNumber numberWithDouble:value];
+        _boxIsDouble = YES;
+        _int64Value = 0;
+        _doubleValue = value;
+    }
+    return _sink(_box, completionHandler, error);
+}
+
+
+- (BOOL)setNullWithCompletionHandler:(void (^const)(PTDiffusionTopicCreationResult *, NSError *))completionHandler
+                               error:(NSError **const)error {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    _box = nil;
+    _int64Value = 0;
+    _doubleValue = 0;
+    return _sink(nil, completionHandler, error);
+}
+
+
+- (BOOL)hasValue {
+    return nil != _box;
+}
+
+@end
@@ -0,0 +1,94 @@
+//
+//  ScalarValueStream.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "SubscriberStreamForwarder.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class Int64ValueStream;
+@class DoubleValueStream;
+
+/**
+ Which of the values passed with an update are absent. An absent value is
+ passed as zero.
+ */
+typedef NS_OPTIONS(NSUInteger, ScalarValueNulls) {
+    ScalarValueNulls_None = 0,
+    /** There was no previous value: this is the first update, or the topic had no value. */
+    ScalarValueNulls_Old = 1 << 0,
+    /** The topic has no value. */
+    ScalarValueNulls_New = 1 << 1,
+};
+
+
+@protocol Int64ValueStreamDelegate <PTDiffusionSubscriberStreamDelegate>
+
+- (void)int64ValueStream:(Int64ValueStream *)stream
+      didUpdateTopicPath:(NSString *)topicPath
+           specification:(PTDiffusionTopicSpecification *)specification
+                oldValue:(int64_t)oldValue
+                newValue:(int64_t)newValue
+                   nulls:(ScalarValueNulls)nulls;
+
+@end
+
+
+@protocol DoubleValueStreamDelegate <PTDiffusionSubscriberStreamDelegate>
+
+- (void)doubleValueStream:(DoubleValueStream *)stream
+       didUpdateTopicPath:(NSString *)topicPath
+            specification:(PTDiffusionTopicSpecification *)specification
+                 oldValue:(double)oldValue
+                 newValue:(double)newValue
+                    nulls:(ScalarValueNulls)nulls;
+
+@end
+
+
+/**
+ Delivers the values of numeric topics to a delegate as C scalars, so that
+ numeric feeds are handled without NSNumber in application code.
+
+ The client library passes NSNumber values to its stream delegate; this
+ unboxes them on the delegate's behalf and keeps nothing per update. The
+ library still boxes each value before the receiver sees it, and that can
+ allocate: most doubles, including two decimal place prices such as 100.01,
+ are not tagged pointers.
+ */
+@interface ScalarValueStream : SubscriberStreamForwarder
+@end
+
+
+@interface Int64ValueStream : ScalarValueStream
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithSubscriberDelegate:(id<PTDiffusionSubscriberStreamDelegate>)delegate NS_UNAVAILABLE;
+
+- (instancetype)initWithDelegate:(id<Int64ValueStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, weak) id<Int64ValueStreamDelegate> delegate;
+
+@end
+
+
+@interface DoubleValueStream : ScalarValueStream
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithSubscriberDelegate:(id<PTDiffusionSubscriberStreamDelegate>)delegate NS_UNAVAILABLE;
+
+- (instancetype)initWithDelegate:(id<DoubleValueStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, weak) id<DoubleValueStreamDelegate> delegate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,103 @@
+//
+//  ScalarValueStream.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "ScalarValueStream.h"
+
+
+static ScalarValueNulls _NullsOf(NSNumber *const oldNumber, NSNumber *const newNumber) {
+    return (oldNumber ? ScalarValueNulls_None : ScalarValueNulls_Old) |
+           (newNumber ? ScalarValueNulls_None : ScalarValueNulls_New);
+}
+
+
+@interface ScalarValueStream () <PTDiffusionNumberValueStreamDelegate>
+@end
+
+
+@implementation ScalarValueStream
+
+
+/**
+ Implemented by subclasses.
+ */
+- (void)diffusionStream:(PTDiffusionValueStream *const)stream
+     didUpdateTopicPath:(NSString *const)topicPath
+          specification:(PTDiffusionTopicSpecification *const)specification
+              oldNumber:(NSNumber *const)oldNumber
+              newNumber:(NSNumber *const)newNumber {
+    [self doesNotRecognizeSelector:_cmd];
+}
+
+@end
+
+
+@implementation Int64ValueStream
+
+
+- (instancetype)initWithDelegate:(id<Int64ValueStreamDelegate> const)delegate {
+    return [super initWithSubscriberDelegate:delegate];
+}
+
+
+- (PTDiffusionValueStream *)createStream {
+    return [PTDiffusionPrimitive int64NumberValueStreamWithDelegate:self];
+}
+
+
+- (id<Int64ValueStreamDelegate>)delegate {
+    return (id<Int64ValueStreamDelegate>)self.subscriberDelegate;
+}
+
+
+- (void)diffusionStream:(PTDiffusionValueStream *const)stream
+     didUpdateTopicPath:(NSString *const)topicPath
+          specification:(PTDiffusionTopicSpecification *const)specification
+              oldNumber:(NSNumber *const)oldNumber
+              newNumber:(NSNumber *const)newNumber {
+    [self.delegate int64ValueStream:self
+                 didUpdateTopicPath:topicPath
+                      specification:specification
+                           oldValue:oldNumber.longLongValue
+                           newValue:newNumber.longLongValue
+                              nulls:_NullsOf(oldNumber, newNumber)];
+}
+
+@end
+
+
+@implementation DoubleValueStream
+
+
+- (instancetype)initWithDelegate:(id<DoubleValueStreamDelegate> const)delegate {
+    return [super initWithSubscriberDelegate:delegate];
+}
+
+
+- (PTDiffusionValueStream *)createStream {
+    return [PTDiffusionPrimitive doubleFloatNumberValueStreamWithDelegate:self];
+}
+
+
+- (id<DoubleValueStreamDelegate>)delegate {
+    return (id<DoubleValueStreamDelegate>)self.subscriberDelegate;
+}
+
+
+- (void)diffusionStream:(PTDiffusionValueStream *const)stream
+     didUpdateTopicPath:(NSString *const)topicPath
+          specification:(PTDiffusionTopicSpecification *const)specification
+              oldNumber:(NSNumber *const)oldNumber
+              newNumber:(NSNumber *const)newNumber {
+    [self.delegate doubleValueStream:self
+                  didUpdateTopicPath:topicPath
+                       specification:specification
+                            oldValue:oldNumber.doubleValue
+                            newValue:newNumber.doubleValue
+                               nulls:_NullsOf(oldNumber, newNumber)];
+}
+
+@end
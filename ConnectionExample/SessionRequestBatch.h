@@ -0,0 +1,74 @@
+//
+//  SessionRequestBatch.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+@class RequestWindow;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The outcome of sending one request to a list of sessions. Responses and
+ errors are indexed in the same order as the session identifiers the batch was
+ sent to.
+ */
+@interface SessionRequestBatchResult : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSArray<PTDiffusionSessionId *> *sessionIds;
+
+@property (nonatomic, readonly) NSUInteger responseCount;
+
+@property (nonatomic, readonly) NSUInteger errorCount;
+
+/**
+ The response from the session at the given index, or `nil` if it failed.
+ */
+- (nullable PTDiffusionJSON *)responseAtIndex:(NSUInteger)index;
+
+/**
+ The error for the session at the given index, or `nil` if it responded.
+ */
+- (nullable NSError *)errorAtIndex:(NSUInteger)index;
+
+@end
+
+
+/**
+ Sends the same request to many sessions with
+ PTDiffusionMessagingControlFeature#sendRequest:toSessionId:path:JSONCompletionHandler:
+ and gathers the responses into one result.
+
+ The request is built by the caller once, so its payload is encoded once and
+ the same PTDiffusionRequest instance is passed for every session. Sends go
+ through a RequestWindow so a large batch does not overrun the session's
+ outbound queue.
+ */
+@interface SessionRequestBatch : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Must be called on the main queue. The completion handler is called once, on
+ the main queue, after every session has responded or failed.
+
+ @param window A window created with the sending session.
+ */
++ (void)sendRequest:(PTDiffusionRequest *)request
+       toSessionIds:(NSArray<PTDiffusionSessionId *> *)sessionIds
+               path:(NSString *)path
+             window:(RequestWindow *)window
+  completionHandler:(void (^)(SessionRequestBatchResult *result))completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
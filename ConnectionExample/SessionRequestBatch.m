@@ -0,0 +1,105 @@
+//
+//  SessionRequestBatch.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "SessionRequestBatch.h"
+#import "RequestWindow.h"
+
+
+@interface SessionRequestBatchResult ()
+
+- (instancetype)initWithSessionIds:(NSArray<PTDiffusionSessionId *> *)sessionIds NS_DESIGNATED_INITIALIZER;
+
+- (void)setResponse:(nullable PTDiffusionJSON *)response error:(nullable NSError *)error atIndex:(NSUInteger)index;
+
+@end
+
+@implementation SessionRequestBatchResult {
+    // Slots hold NSNull until filled, so the arrays can be preallocated.
+    NSMutableArray *_responses;
+    NSMutableArray *_errors;
+}
+
+- (instancetype)initWithSessionIds:(NSArray<PTDiffusionSessionId *> *const)sessionIds {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _sessionIds = [sessionIds copy];
+    const NSUInteger count = _sessionIds.count;
+    _responses = [NSMutableArray arrayWithCapacity:count];
+    _errors = [NSMutableArray arrayWithCapacity:count];
+    NSNull *const null = [NSNull null];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [_responses addObject:null];
+        [_errors addObject:null];
+    }
+    return self;
+}
+
+- (void)setResponse:(PTDiffusionJSON *const)response error:(NSError *const)error atIndex:(const NSUInteger)index {
+    if (error) {
+        _errors[index] = error;
+        ++_errorCount;
+    } else if (response) {
+        _responses[index] = response;
+        ++_responseCount;
+    }
+}
+
+- (PTDiffusionJSON *)responseAtIndex:(const NSUInteger)index {
+    const id response = _responses[index];
+    return response == [NSNull null] ? nil : response;
+}
+
+- (NSError *)errorAtIndex:(const NSUInteger)index {
+    const id error = _errors[index];
+    return error == [NSNull null] ? nil : error;
+}
+
+@end
+
+
+@implementation SessionRequestBatch
+
++ (void)sendRequest:(PTDiffusionRequest *const)request
+       toSessionIds:(NSArray<PTDiffusionSessionId *> *const)sessionIds
+               path:(NSString *const)path
+             window:(RequestWindow *const)window
+  completionHandler:(void (^const)(SessionRequestBatchResult *))completionHandler {
+    PTDiffusionSession *const session = window.session;
+    if (!session) {
+        [NSException raise:NSInvalidArgumentException format:@"Window has no session"];
+    }
+    SessionRequestBatchResult *const result = [[SessionRequestBatchResult alloc] initWithSessionIds:sessionIds];
+    const NSUInteger count = result.sessionIds.count;
+    if (0 == count) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(result);
+        });
+        return;
+    }
+
+    PTDiffusionMessagingControlFeature *const messagingControl = session.messagingControl;
+    __block NSUInteger remaining = count;
+    for (NSUInteger i = 0; i < count; ++i) {
+        PTDiffusionSessionId *const sessionId = result.sessionIds[i];
+        [window performOperation:^(const dispatch_block_t done) {
+            [messagingControl sendRequest:request
+                              toSessionId:sessionId
+                                     path:path
+                    JSONCompletionHandler:^(PTDiffusionJSON *const json, NSError *const error)
+            {
+                [result setResponse:json error:error atIndex:i];
+                done();
+                if (0 == --remaining) {
+                    completionHandler(result);
+                }
+            }];
+        }];
+    }
+}
+
+@end
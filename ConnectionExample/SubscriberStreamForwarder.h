@@ -0,0 +1,47 @@
+//
+//  SubscriberStreamForwarder.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The delegate of a value stream that hands values to its own delegate in
+ another form. Subclasses translate the value callbacks; subscription,
+ unsubscription, failure and close notifications are forwarded unchanged.
+
+ As with the library's streams, the delegate is not retained; neither is the
+ receiver, which is the delegate of its stream and must be kept by the caller.
+ */
+@interface SubscriberStreamForwarder : NSObject <PTDiffusionSubscriberStreamDelegate>
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Calls createStream.
+ */
+- (instancetype)initWithSubscriberDelegate:(id<PTDiffusionSubscriberStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, weak) id<PTDiffusionSubscriberStreamDelegate> subscriberDelegate;
+
+/**
+ Add it with PTDiffusionTopicsFeature#addStream:withSelectorExpression:
+ */
+@property (nonatomic, readonly) PTDiffusionValueStream *stream;
+
+/**
+ Creates a stream with the receiver as its delegate. Subclasses must override
+ this; it is called once, by the initializer.
+ */
+- (PTDiffusionValueStream *)createStream;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,57 @@
+//
+//  SubscriberStreamForwarder.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "SubscriberStreamForwarder.h"
+
+
+@implementation SubscriberStreamForwarder
+
+
+- (instancetype)initWithSubscriberDelegate:(id<PTDiffusionSubscriberStreamDelegate> const)delegate {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _subscriberDelegate = delegate;
+    _stream = [self createStream];
+    return self;
+}
+
+
+- (PTDiffusionValueStream *)createStream {
+    [self doesNotRecognizeSelector:_cmd];
+    return nil;
+}
+
+
+- (void)     diffusionStream:(PTDiffusionStream *const)stream
+     didSubscribeToTopicPath:(NSString *const)topicPath
+               specification:(PTDiffusionTopicSpecification *const)specification {
+    [_subscriberDelegate diffusionStream:stream didSubscribeToTopicPath:topicPath specification:specification];
+}
+
+
+- (void)         diffusionStream:(PTDiffusionStream *const)stream
+     didUnsubscribeFromTopicPath:(NSString *const)topicPath
+                   specification:(PTDiffusionTopicSpecification *const)specification
+                          reason:(const PTDiffusionTopicUnsubscriptionReason)reason {
+    [_subscriberDelegate diffusionStream:stream
+             didUnsubscribeFromTopicPath:topicPath
+                           specification:specification
+                                  reason:reason];
+}
+
+
+- (void)diffusionStream:(PTDiffusionStream *const)stream didFailWithError:(NSError *const)error {
+    [_subscriberDelegate diffusionStream:stream didFailWithError:error];
+}
+
+
+- (void)diffusionDidCloseStream:(PTDiffusionStream *const)stream {
+    [_subscriberDelegate diffusionDidCloseStream:stream];
+}
+
+@end
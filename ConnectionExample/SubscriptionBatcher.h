@@ -0,0 +1,82 @@
+//
+//  SubscriptionBatcher.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Coalesces subscribe and unsubscribe calls made within a short interval into
+ as few PTDiffusionTopicsFeature requests as possible.
+
+ Calls are gathered for `interval` after the first call of a batch. Repeated
+ calls for the same expression collapse to the last one, so a subscribe
+ followed by an unsubscribe of the same expression sends only the
+ unsubscribe, and the reverse sends only the subscribe; that is the outcome
+ the server would reach by applying both. What remains is sent as
+ PTDiffusionTopicSelector#topicSelectorWithAnyExpression: composites, one per
+ run of consecutive subscribes or unsubscribes, so that calls for overlapping
+ selectors still take effect in the order they were made. When an application
+ issues only subscribes, a batch is a single request.
+
+ Every call's completion handler is called, on the main queue, with the
+ outcome of the request that carried its expression, including calls that
+ were collapsed into a later one.
+
+ Instances are confined to the main queue.
+ */
+@interface SubscriptionBatcher : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSession:(PTDiffusionSession *)session NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) PTDiffusionSession *session;
+
+/**
+ How long calls are gathered before a batch is sent. Defaults to 10ms.
+ */
+@property (nonatomic) NSTimeInterval interval;
+
+/**
+ The most expressions sent in one composite selector. Defaults to 1000.
+ */
+@property (nonatomic) NSUInteger maximumExpressionsPerRequest;
+
+/**
+ As PTDiffusionTopicsFeature#subscribeWithTopicSelectorExpression:completionHandler:
+ */
+- (void)subscribeWithTopicSelectorExpression:(NSString *)expression
+                           completionHandler:(void (^)(NSError * _Nullable error))completionHandler;
+
+/**
+ As PTDiffusionTopicsFeature#unsubscribeFromTopicSelectorExpression:completionHandler:
+ */
+- (void)unsubscribeFromTopicSelectorExpression:(NSString *)expression
+                             completionHandler:(void (^)(NSError * _Nullable error))completionHandler;
+
+/**
+ Sends the pending batch now.
+ */
+- (void)flush;
+
+@property (nonatomic, readonly) NSUInteger callCount;
+
+/**
+ Calls superseded by a later call for the same expression with the opposite
+ effect.
+ */
+@property (nonatomic, readonly) NSUInteger cancelledCount;
+
+@property (nonatomic, readonly) NSUInteger requestCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
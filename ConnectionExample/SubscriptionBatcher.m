@@ -0,0 +1,156 @@
+//
+//  SubscriptionBatcher.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "SubscriptionBatcher.h"
+
+
+/**
+ The pending call for one expression.
+ */
+@interface SubscriptionBatcherCall : NSObject
+
+@property (nonatomic, copy) NSString *expression;
+@property (nonatomic) BOOL subscribe;
+@property (nonatomic, readonly) NSMutableArray<void (^)(NSError *)> *completionHandlers;
+
+@end
+
+@implementation SubscriptionBatcherCall
+
+- (instancetype)init {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _completionHandlers = [NSMutableArray new];
+    return self;
+}
+
+@end
+
+
+@implementation SubscriptionBatcher {
+    // In order of each expression's latest call. Calls compare by identity.
+    NSMutableOrderedSet<SubscriptionBatcherCall *> *_pending;
+    NSMutableDictionary<NSString *, SubscriptionBatcherCall *> *_pendingByExpression;
+    BOOL _flushScheduled;
+    // Distinguishes the scheduled flush of each batch, so one overtaken by a
+    // call to flush does not cut the next batch short.
+    NSUInteger _batchNumber;
+}
+
+
+- (instancetype)initWithSession:(PTDiffusionSession *const)session {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _session = session;
+    _interval = 0.01;
+    _maximumExpressionsPerRequest = 1000;
+    _pending = [NSMutableOrderedSet new];
+    _pendingByExpression = [NSMutableDictionary new];
+    return self;
+}
+
+
+- (void)subscribeWithTopicSelectorExpression:(NSString *const)expression
+                           completionHandler:(void (^const)(NSError *))completionHandler {
+    [self addCallWithExpression:expression subscribe:YES completionHandler:completionHandler];
+}
+
+
+- (void)unsubscribeFromTopicSelectorExpression:(NSString *const)expression
+                             completionHandler:(void (^const)(NSError *))completionHandler {
+    [self addCallWithExpression:expression subscribe:NO completionHandler:completionHandler];
+}
+
+
+- (void)addCallWithExpression:(NSString *const)expression
+                    subscribe:(const BOOL)subscribe
+            completionHandler:(void (^const)(NSError *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    if (!expression || !completionHandler) {
+        [NSException raise:NSInvalidArgumentException format:@"Expression and completion handler are required"];
+    }
+    ++_callCount;
+
+    SubscriptionBatcherCall *call = _pendingByExpression[expression];
+    if (call) {
+        if (call.subscribe != subscribe) {
+            ++_cancelledCount;
+        }
+        // Moved to the end, so the collapsed call keeps the position of the
+        // latest one.
+        [_pending removeObject:call];
+    } else {
+        call = [SubscriptionBatcherCall new];
+        call.expression = expression;
+        _pendingByExpression[call.expression] = call;
+    }
+    call.subscribe = subscribe;
+    [call.completionHandlers addObject:[completionHandler copy]];
+    [_pending addObject:call];
+
+    if (!_flushScheduled) {
+        _flushScheduled = YES;
+        const NSUInteger batchNumber = _batchNumber;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_interval * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            if (self->_flushScheduled && self->_batchNumber == batchNumber) {
+                [self flush];
+            }
+        });
+    }
+}
+
+
+- (void)flush {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    _flushScheduled = NO;
+    ++_batchNumber;
+    NSArray<SubscriptionBatcherCall *> *const calls = _pending.array;
+    [_pending removeAllObjects];
+    [_pendingByExpression removeAllObjects];
+
+    const NSUInteger limit = MAX(_maximumExpressionsPerRequest, (NSUInteger)1);
+    NSUInteger start = 0;
+    while (start < calls.count) {
+        const BOOL subscribe = calls[start].subscribe;
+        NSUInteger end = start + 1;
+        while (end < calls.count && end - start < limit && calls[end].subscribe == subscribe) {
+            ++end;
+        }
+        [self sendCalls:[calls subarrayWithRange:NSMakeRange(start, end - start)] subscribe:subscribe];
+        start = end;
+    }
+}
+
+
+- (void)sendCalls:(NSArray<SubscriptionBatcherCall *> *const)calls subscribe:(const BOOL)subscribe {
+    NSString *expression = calls.firstObject.expression;
+    if (calls.count > 1) {
+        NSMutableArray<NSString *> *const expressions = [NSMutableArray arrayWithCapacity:calls.count];
+        for (SubscriptionBatcherCall *const call in calls) {
+            [expressions addObject:call.expression];
+        }
+        expression = [PTDiffusionTopicSelector topicSelectorWithAnyExpression:expressions].expression;
+    }
+
+    void (^const completionHandler)(NSError *) = ^(NSError *const error) {
+        for (SubscriptionBatcherCall *const call in calls) {
+            for (void (^const handler)(NSError *) in call.completionHandlers) {
+                handler(error);
+            }
+        }
+    };
+    ++_requestCount;
+    if (subscribe) {
+        [_session.topics subscribeWithTopicSelectorExpression:expression completionHandler:completionHandler];
+    } else {
+        [_session.topics unsubscribeFromTopicSelectorExpression:expression completionHandler:completionHandler];
+    }
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  TimeSeriesAppendBatch.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+@class RequestWindow;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Appends one value to a time series topic. Implementations call the completion
+ handler on the main queue with the sequence number the event was given.
+ */
+typedef void (^TimeSeriesAppender)(NSString *topicPath, id value,
+    void (^completionHandler)(UInt64 sequence, NSError * _Nullable error));
+
+/**
+ The sequence number recorded for an append that failed.
+ */
+extern const UInt64 TimeSeriesAppendBatchNoSequence;
+
+@interface TimeSeriesAppendBatchResult : NSObject
+
+@property (nonatomic, readonly) NSArray<NSString *> *topicPaths;
+
+@property (nonatomic, readonly) NSUInteger eventCount;
+
+@property (nonatomic, readonly) NSUInteger errorCount;
+
+/**
+ The first error reported, if any.
+ */
+@property (nonatomic, readonly, nullable) NSError *firstError;
+
+/**
+ The sequence numbers given to the values appended to a topic, in the order
+ the values were supplied, with TimeSeriesAppendBatchNoSequence for appends
+ that failed. The array has one entry per value and lives as long as the
+ result.
+ */
+- (const UInt64 *)sequencesForTopicPath:(NSString *)topicPath;
+
+@end
+
+
+/**
+ Appends many values to one or more time series topics with as many appends in
+ flight as a RequestWindow allows.
+
+ Every append is a separate request to the server, but the client library
+ writes whatever is queued for the session in as few frames as it can, so
+ keeping many appends in flight gets them onto the wire together instead of
+ one per round trip. Appends to a topic are sent in the order given and topics
+ are interleaved so that all of them progress together.
+ */
+@interface TimeSeriesAppendBatch : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Must be called on the main queue; the completion handler is called on the
+ main queue once every append has completed.
+ */
++ (void)appendValuesByTopicPath:(NSDictionary<NSString *, NSArray *> *)valuesByTopicPath
+                       appender:(TimeSeriesAppender)appender
+                         window:(RequestWindow *)window
+              completionHandler:(void (^)(TimeSeriesAppendBatchResult *result))completionHandler;
+
++ (void)appendValues:(NSArray *)values
+         toTopicPath:(NSString *)topicPath
+            appender:(TimeSeriesAppender)appender
+              window:(RequestWindow *)window
+   completionHandler:(void (^)(TimeSeriesAppendBatchResult *result))completionHandler;
+
+/**
+ Appends PTDiffusionJSON values.
+ */
++ (TimeSeriesAppender)JSONAppenderWithSession:(PTDiffusionSession *)session;
+
+/**
+ Appends NSNumber values to int64 time series.
+ */
++ (TimeSeriesAppender)int64AppenderWithSession:(PTDiffusionSession *)session;
+
+/**
+ Appends NSNumber values to double time series.
+ */
++ (TimeSeriesAppender)doubleAppenderWithSession:(PTDiffusionSession *)session;
+
+/**
+ Appends NSString values.
+ */
++ (TimeSeriesAppender)stringAppenderWithSession:(PTDiffusionSession *)session;
+
+/**
+ A stand-in for a server, for benchmarks. Each append completes after the
+ given latency with the next sequence number for its topic.
+ */
++ (TimeSeriesAppender)localAppenderWithLatency:(NSTimeInterval)latency;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,237 @@
+//
+//  TimeSeriesAppendBatch.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "TimeSeriesAppendBatch.h"
+#import "RequestWindow.h"
+
+
+const UInt64 TimeSeriesAppendBatchNoSequence = UINT64_MAX;
+
+
+@interface TimeSeriesAppendBatchResult ()
+
+- (instancetype)initWithValuesByTopicPath:(NSDictionary<NSString *, NSArray *> *)valuesByTopicPath NS_DESIGNATED_INITIALIZER;
+
+- (void)setSequence:(UInt64)sequence error:(nullable NSError *)error forTopicAtIndex:(NSUInteger)topicIndex valueIndex:(NSUInteger)valueIndex;
+
+@end
+
+@implementation TimeSeriesAppendBatchResult {
+    NSDictionary<NSString *, NSMutableData *> *_sequencesByTopicPath;
+    NSArray<NSMutableData *> *_sequences;
+}
+
+- (instancetype)initWithValuesByTopicPath:(NSDictionary<NSString *, NSArray *> *const)valuesByTopicPath {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _topicPaths = valuesByTopicPath.allKeys;
+    NSMutableDictionary<NSString *, NSMutableData *> *const byPath = [NSMutableDictionary new];
+    NSMutableArray<NSMutableData *> *const sequences = [NSMutableArray new];
+    for (NSString *const topicPath in _topicPaths) {
+        const NSUInteger count = valuesByTopicPath[topicPath].count;
+        NSMutableData *const data = [NSMutableData dataWithLength:count * sizeof(UInt64)];
+        UInt64 *const bytes = data.mutableBytes;
+        for (NSUInteger i = 0; i < count; ++i) {
+            bytes[i] = TimeSeriesAppendBatchNoSequence;
+        }
+        byPath[topicPath] = data;
+        [sequences addObject:data];
+        _eventCount += count;
+    }
+    _sequencesByTopicPath = byPath;
+    _sequences = sequences;
+    return self;
+}
+
+- (void)setSequence:(const UInt64)sequence
+              error:(NSError *const)error
+    forTopicAtIndex:(const NSUInteger)topicIndex
+         valueIndex:(const NSUInteger)valueIndex {
+    if (error) {
+        ++_errorCount;
+        if (!_firstError) {
+            _firstError = error;
+        }
+        return;
+    }
+    ((UInt64 *)_sequences[topicIndex].mutableBytes)[valueIndex] = sequence;
+}
+
+- (const UInt64 *)sequencesForTopicPath:(NSString *const)topicPath {
+    NSMutableData *const data = _sequencesByTopicPath[topicPath];
+    if (!data) {
+        [NSException raise:NSInvalidArgumentException format:@"No values for %@", topicPath];
+    }
+    return data.bytes;
+}
+
+@end
+
+
+/**
+ Assigns sequence numbers per topic after a fixed latency. All state is
+ confined to a private serial queue.
+ */
+@interface TimeSeriesAppendBatchLocalAppender : NSObject
+
+- (instancetype)initWithLatency:(NSTimeInterval)latency;
+
+- (void)appendToTopicPath:(NSString *)topicPath completionHandler:(void (^)(UInt64 sequence, NSError * _Nullable error))completionHandler;
+
+@end
+
+@implementation TimeSeriesAppendBatchLocalAppender {
+    dispatch_queue_t _queue;
+    int64_t _latencyNanoseconds;
+    NSMutableDictionary<NSString *, NSNumber *> *_nextSequences;
+}
+
+- (instancetype)initWithLatency:(const NSTimeInterval)latency {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _queue = dispatch_queue_create("TimeSeriesAppendBatch.appender", DISPATCH_QUEUE_SERIAL);
+    _latencyNanoseconds = (int64_t)(latency * NSEC_PER_SEC);
+    _nextSequences = [NSMutableDictionary new];
+    return self;
+}
+
+- (void)appendToTopicPath:(NSString *const)topicPath completionHandler:(void (^const)(UInt64, NSError *))completionHandler {
+    dispatch_async(_queue, ^{
+        const UInt64 sequence = self->_nextSequences[topicPath].unsignedLongLongValue;
+        self->_nextSequences[topicPath] = @(sequence + 1);
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, self->_latencyNanoseconds), dispatch_get_main_queue(), ^{
+            completionHandler(sequence, nil);
+        });
+    });
+}
+
+@end
+
+
+@implementation TimeSeriesAppendBatch
+
++ (void)appendValuesByTopicPath:(NSDictionary<NSString *, NSArray *> *const)valuesByTopicPath
+                       appender:(const TimeSeriesAppender)appender
+                         window:(RequestWindow *const)window
+              completionHandler:(void (^const)(TimeSeriesAppendBatchResult *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Batches must be started on the main queue");
+    TimeSeriesAppendBatchResult *const result =
+        [[TimeSeriesAppendBatchResult alloc] initWithValuesByTopicPath:valuesByTopicPath];
+    if (0 == result.eventCount) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(result);
+        });
+        return;
+    }
+
+    NSArray<NSString *> *const topicPaths = result.topicPaths;
+    NSMutableArray<NSArray *> *const valueArrays = [NSMutableArray arrayWithCapacity:topicPaths.count];
+    NSUInteger longest = 0;
+    for (NSString *const topicPath in topicPaths) {
+        NSArray *const values = valuesByTopicPath[topicPath];
+        [valueArrays addObject:values];
+        longest = MAX(longest, values.count);
+    }
+
+    // Round by round, one value from each topic that has any left.
+    __block NSUInteger remaining = result.eventCount;
+    for (NSUInteger valueIndex = 0; valueIndex < longest; ++valueIndex) {
+        for (NSUInteger topicIndex = 0; topicIndex < topicPaths.count; ++topicIndex) {
+            NSArray *const values = valueArrays[topicIndex];
+            if (valueIndex >= values.count) {
+                continue;
+            }
+            NSString *const topicPath = topicPaths[topicIndex];
+            const id value = values[valueIndex];
+            [window performOperation:^(const dispatch_block_t done) {
+                appender(topicPath, value, ^(const UInt64 sequence, NSError *const error) {
+                    [result setSequence:sequence error:error forTopicAtIndex:topicIndex valueIndex:valueIndex];
+                    done();
+                    if (0 == --remaining) {
+                        completionHandler(result);
+                    }
+                });
+            }];
+        }
+    }
+}
+
+
++ (void)appendValues:(NSArray *const)values
+         toTopicPath:(NSString *const)topicPath
+            appender:(const TimeSeriesAppender)appender
+              window:(RequestWindow *const)window
+   completionHandler:(void (^const)(TimeSeriesAppendBatchResult *))completionHandler {
+    [self appendValuesByTopicPath:@{topicPath: values}
+                         appender:appender
+                           window:window
+                completionHandler:completionHandler];
+}
+
+
++ (TimeSeriesAppender)JSONAppenderWithSession:(PTDiffusionSession *const)session {
+    PTDiffusionTimeSeriesFeature *const timeSeries = session.timeSeries;
+    return ^(NSString *const topicPath, const id value, void (^const completionHandler)(UInt64, NSError *)) {
+        [timeSeries appendToTopicPath:topicPath
+                            JSONValue:value
+                    completionHandler:^(PTDiffusionTimeSeriesEventMetadata *const metadata, NSError *const error)
+        {
+            completionHandler(metadata ? metadata.sequence : TimeSeriesAppendBatchNoSequence, error);
+        }];
+    };
+}
+
+
++ (TimeSeriesAppender)int64AppenderWithSession:(PTDiffusionSession *const)session {
+    PTDiffusionTimeSeriesFeature *const timeSeries = session.timeSeries;
+    return ^(NSString *const topicPath, const id value, void (^const completionHandler)(UInt64, NSError *)) {
+        [timeSeries appendToTopicPath:topicPath
+                     int64NumberValue:value
+                    completionHandler:^(PTDiffusionTimeSeriesEventMetadata *const metadata, NSError *const error)
+        {
+            completionHandler(metadata ? metadata.sequence : TimeSeriesAppendBatchNoSequence, error);
+        }];
+    };
+}
+
+
++ (TimeSeriesAppender)doubleAppenderWithSession:(PTDiffusionSession *const)session {
+    PTDiffusionTimeSeriesFeature *const timeSeries = session.timeSeries;
+    return ^(NSString *const topicPath, const id value, void (^const completionHandler)(UInt64, NSError *)) {
+        [timeSeries appendToTopicPath:topicPath
+               doubleFloatNumberValue:value
+                    completionHandler:^(PTDiffusionTimeSeriesEventMetadata *const metadata, NSError *const error)
+        {
+            completionHandler(metadata ? metadata.sequence : TimeSeriesAppendBatchNoSequence, error);
+        }];
+    };
+}
+
+
++ (TimeSeriesAppender)stringAppenderWithSession:(PTDiffusionSession *const)session {
+    PTDiffusionTimeSeriesFeature *const timeSeries = session.timeSeries;
+    return ^(NSString *const topicPath, const id value, void (^const completionHandler)(UInt64, NSError *)) {
+        [timeSeries appendToTopicPath:topicPath
+                          stringValue:value
+                    completionHandler:^(PTDiffusionTimeSeriesEventMetadata *const metadata, NSError *const error)
+        {
+            completionHandler(metadata ? metadata.sequence : TimeSeriesAppendBatchNoSequence, error);
+        }];
+    };
+}
+
+
++ (TimeSeriesAppender)localAppenderWithLatency:(const NSTimeInterval)latency {
+    TimeSeriesAppendBatchLocalAppender *const local = [[TimeSeriesAppendBatchLocalAppender alloc] initWithLatency:latency];
+    return ^(NSString *const topicPath, const id value, void (^const completionHandler)(UInt64, NSError *)) {
+        [local appendToTopicPath:topicPath completionHandler:completionHandler];
+    };
+}
+
+@end
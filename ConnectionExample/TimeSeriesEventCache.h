@@ -0,0 +1,91 @@
+//
+//  TimeSeriesEventCache.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Caches the value view of JSON time series topics so that overlapping range
+ queries are answered locally, with only the missing sequence ranges queried
+ from the server.
+
+ For each topic the cache records which sequence numbers it has complete
+ knowledge of. Query results fill in those ranges, and while the cache's
+ stream is subscribed to a topic, new events and edits are added as they
+ arrive. A topic's entries are dropped when the stream is unsubscribed from it,
+ because edits made while unsubscribed would be missed; call
+ invalidateTopicPath: when the same is true for a topic the stream was never
+ subscribed to.
+
+ The cache is the delegate of its stream, which does not retain it. Instances
+ are confined to the main queue.
+ */
+@interface TimeSeriesEventCache : NSObject <PTDiffusionJSONTimeSeriesEventValueStreamDelegate>
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithSession:(PTDiffusionSession *)session NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) PTDiffusionSession *session;
+
+/**
+ A JSON time series event stream feeding the cache. Add it with
+ PTDiffusionTopicsFeature#addStream:withSelectorExpression: for the topics to
+ keep current.
+ */
+@property (nonatomic, readonly) PTDiffusionValueStream *stream;
+
+/**
+ The number of events kept for each topic before the oldest are evicted.
+ Defaults to 100000.
+ */
+@property (nonatomic) NSUInteger maximumEventsPerTopic;
+
+/**
+ Queries answered without contacting the server.
+ */
+@property (nonatomic, readonly) NSUInteger hitCount;
+
+/**
+ Queries sent to the server, counting each gap separately.
+ */
+@property (nonatomic, readonly) NSUInteger fetchCount;
+
+/**
+ The events with original sequence numbers from `fromSequence` to `toSequence`
+ inclusive, as PTDiffusionTimeSeriesRangeQuery#fromSequence: and
+ PTDiffusionTimeSeriesRangeQuery#toSequence: would return them. Pass INT64_MAX
+ as `toSequence` for the rest of the series.
+ */
+- (void)eventsAtTopicPath:(NSString *)topicPath
+             fromSequence:(UInt64)fromSequence
+               toSequence:(UInt64)toSequence
+        completionHandler:(void (^)(NSArray<PTDiffusionJSONTimeSeriesEvent *> * _Nullable events, NSError * _Nullable error))completionHandler;
+
+/**
+ As PTDiffusionTimeSeriesRangeQuery#fromLastWithCount:
+ */
+- (void)lastEventsAtTopicPath:(NSString *)topicPath
+                        count:(UInt64)count
+            completionHandler:(void (^)(NSArray<PTDiffusionJSONTimeSeriesEvent *> * _Nullable events, NSError * _Nullable error))completionHandler;
+
+/**
+ As PTDiffusionTimeSeriesRangeQuery#fromLastWithTimeInterval:
+ */
+- (void)lastEventsAtTopicPath:(NSString *)topicPath
+                 timeInterval:(NSTimeInterval)timeInterval
+            completionHandler:(void (^)(NSArray<PTDiffusionJSONTimeSeriesEvent *> * _Nullable events, NSError * _Nullable error))completionHandler;
+
+- (void)invalidateTopicPath:(NSString *)topicPath;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,385 @@
+//
+//  TimeSeriesEventCache.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "TimeSeriesEventCache.h"
+
+
+/**
+ The highest sequence number an NSIndexSet can hold. INT64_MAX, the highest a
+ time series can hold, is NSNotFound.
+ */
+static const UInt64 _MaximumCachedSequence = NSNotFound - 1;
+
+
+/**
+ The cached value view of one topic. Events are held in the slot of their
+ original event, so an edit replaces the value it edits.
+ */
+@interface TimeSeriesEventCacheSeries : NSObject
+
+/**
+ Sequence numbers, original or edit, about which nothing is missing.
+ */
+@property (nonatomic, readonly) NSMutableIndexSet *covered;
+
+/**
+ Original sequence numbers with an entry in events.
+ */
+@property (nonatomic, readonly) NSMutableIndexSet *present;
+
+@property (nonatomic, readonly) NSMutableDictionary<NSNumber *, PTDiffusionJSONTimeSeriesEvent *> *events;
+
+/**
+ Set once the stream has delivered an event, after which latestSequence and
+ latestTimestamp are those of the last event in the series.
+ */
+@property (nonatomic) BOOL live;
+@property (nonatomic) UInt64 latestSequence;
+@property (nonatomic) SInt64 latestTimestamp;
+
+@end
+
+@implementation TimeSeriesEventCacheSeries
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _covered = [NSMutableIndexSet new];
+        _present = [NSMutableIndexSet new];
+        _events = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+
+- (void)addEvent:(PTDiffusionJSONTimeSeriesEvent *const)event {
+    const UInt64 original = event.originalEvent.sequence;
+    PTDiffusionJSONTimeSeriesEvent *const existing = _events[@(original)];
+    if (existing && existing.sequence > event.sequence) {
+        return;
+    }
+    _events[@(original)] = event;
+    [_present addIndex:(NSUInteger)original];
+}
+
+
+- (NSArray<PTDiffusionJSONTimeSeriesEvent *> *)eventsInRange:(const NSRange)range {
+    NSMutableArray<PTDiffusionJSONTimeSeriesEvent *> *const events = [NSMutableArray new];
+    [_present enumerateIndexesInRange:range options:0 usingBlock:^(const NSUInteger sequence, BOOL *const stop) {
+        [events addObject:self->_events[@(sequence)]];
+    }];
+    return events;
+}
+
+
+- (NSArray<NSValue *> *)gapsInRange:(const NSRange)range {
+    NSMutableIndexSet *const missing = [NSMutableIndexSet indexSetWithIndexesInRange:range];
+    [missing removeIndexes:_covered];
+    NSMutableArray<NSValue *> *const gaps = [NSMutableArray new];
+    [missing enumerateRangesUsingBlock:^(const NSRange gap, BOOL *const stop) {
+        [gaps addObject:[NSValue valueWithRange:gap]];
+    }];
+    return gaps;
+}
+
+
+/**
+ Walks back from the latest event through the covered range containing it,
+ collecting events until the test fails. Returns `nil` if the range runs out
+ first, unless it reaches the start of the series.
+ */
+- (nullable NSArray<PTDiffusionJSONTimeSeriesEvent *> *)latestEventsPassingTest:(BOOL (^)(PTDiffusionJSONTimeSeriesEvent *event, NSUInteger count))test {
+    if (!_live) {
+        return nil;
+    }
+    __block NSRange run = NSMakeRange(NSNotFound, 0);
+    const NSUInteger latest = (NSUInteger)_latestSequence;
+    [_covered enumerateRangesWithOptions:NSEnumerationReverse usingBlock:^(const NSRange range, BOOL *const stop) {
+        if (NSLocationInRange(latest, range)) {
+            run = range;
+            *stop = YES;
+        }
+    }];
+    if (NSNotFound == run.location) {
+        return nil;
+    }
+
+    NSMutableArray<PTDiffusionJSONTimeSeriesEvent *> *const events = [NSMutableArray new];
+    __block BOOL satisfied = NO;
+    [_present enumerateIndexesInRange:run options:NSEnumerationReverse usingBlock:^(const NSUInteger sequence, BOOL *const stop) {
+        PTDiffusionJSONTimeSeriesEvent *const event = self->_events[@(sequence)];
+        if (!test(event, events.count)) {
+            satisfied = YES;
+            *stop = YES;
+            return;
+        }
+        [events addObject:event];
+    }];
+    if (!satisfied && 0 != run.location) {
+        return nil;
+    }
+    return events.reverseObjectEnumerator.allObjects;
+}
+
+
+- (void)evictToCount:(const NSUInteger)maximumCount {
+    if (_present.count <= maximumCount) {
+        return;
+    }
+    __block NSUInteger remaining = _present.count - maximumCount;
+    __block NSUInteger cut = 0;
+    [_present enumerateIndexesUsingBlock:^(const NSUInteger sequence, BOOL *const stop) {
+        [self->_events removeObjectForKey:@(sequence)];
+        cut = sequence;
+        *stop = 0 == --remaining;
+    }];
+    [_present removeIndexesInRange:NSMakeRange(0, cut + 1)];
+    [_covered removeIndexesInRange:NSMakeRange(0, cut + 1)];
+}
+
+@end
+
+
+@implementation TimeSeriesEventCache {
+    NSMutableDictionary<NSString *, TimeSeriesEventCacheSeries *> *_series;
+}
+
+
+- (instancetype)initWithSession:(PTDiffusionSession *const)session {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _session = session;
+    _stream = [PTDiffusionJSON timeSeriesEventValueStreamWithDelegate:self];
+    _maximumEventsPerTopic = 100000;
+    _series = [NSMutableDictionary new];
+    return self;
+}
+
+
+- (void)setMaximumEventsPerTopic:(const NSUInteger)maximumEventsPerTopic {
+    if (0 == maximumEventsPerTopic) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one event must be kept"];
+    }
+    _maximumEventsPerTopic = maximumEventsPerTopic;
+    for (TimeSeriesEventCacheSeries *const series in _series.allValues) {
+        [series evictToCount:maximumEventsPerTopic];
+    }
+}
+
+
+- (TimeSeriesEventCacheSeries *)seriesForTopicPath:(NSString *const)topicPath {
+    TimeSeriesEventCacheSeries *series = _series[topicPath];
+    if (!series) {
+        series = [TimeSeriesEventCacheSeries new];
+        _series[topicPath] = series;
+    }
+    return series;
+}
+
+
+- (void)invalidateTopicPath:(NSString *const)topicPath {
+    [_series removeObjectForKey:topicPath];
+}
+
+
+/**
+ Adds the events of a query result, then marks as covered the sequence numbers
+ from `lower` to `upper` that the result is known to account for.
+ */
+- (void)mergeResult:(PTDiffusionJSONTimeSeriesQueryResult *const)result
+           intoSeries:(TimeSeriesEventCacheSeries *const)series
+                lower:(UInt64)lower
+                upper:(const UInt64)upper {
+    NSArray<PTDiffusionJSONTimeSeriesEvent *> *const events = result.jsonEvents;
+    UInt64 highest = 0;
+    for (PTDiffusionJSONTimeSeriesEvent *const event in events) {
+        [series addEvent:event];
+        highest = MAX(highest, MAX(event.sequence, event.originalEvent.sequence));
+    }
+    // A limited result holds the latest events of the range only.
+    if (!result.isComplete && events.count > 0) {
+        lower = events.firstObject.originalEvent.sequence;
+    }
+    // Past the last event seen nothing is known unless the stream says where
+    // the series ends.
+    if (events.count > 0 || series.live) {
+        const UInt64 end = MIN(MIN(upper, _MaximumCachedSequence),
+                               series.live ? MAX(series.latestSequence, highest) : highest);
+        if (end >= lower) {
+            [series.covered addIndexesInRange:NSMakeRange((NSUInteger)lower, (NSUInteger)(end - lower + 1))];
+        }
+    }
+    [series evictToCount:_maximumEventsPerTopic];
+}
+
+
+- (void)eventsAtTopicPath:(NSString *const)topicPath
+             fromSequence:(const UInt64)fromSequence
+               toSequence:(UInt64)toSequence
+        completionHandler:(void (^const)(NSArray<PTDiffusionJSONTimeSeriesEvent *> *, NSError *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Caches are confined to the main queue");
+    if (fromSequence > toSequence || toSequence > INT64_MAX) {
+        [NSException raise:NSInvalidArgumentException format:@"Invalid range %llu to %llu", fromSequence, toSequence];
+    }
+    // No series gets this far, so "to the end" can be asked for with INT64_MAX.
+    toSequence = MIN(toSequence, _MaximumCachedSequence);
+    if (fromSequence > toSequence) {
+        [NSException raise:NSInvalidArgumentException format:@"Invalid range %llu to %llu", fromSequence, toSequence];
+    }
+    TimeSeriesEventCacheSeries *const series = [self seriesForTopicPath:topicPath];
+    const NSRange range = NSMakeRange((NSUInteger)fromSequence, (NSUInteger)(toSequence - fromSequence + 1));
+    NSArray<NSValue *> *const gaps = [series gapsInRange:range];
+    if (0 == gaps.count) {
+        ++_hitCount;
+        NSArray<PTDiffusionJSONTimeSeriesEvent *> *const events = [series eventsInRange:range];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(events, nil);
+        });
+        return;
+    }
+
+    PTDiffusionTimeSeriesRangeQuery *const query = [PTDiffusionTimeSeriesRangeQuery new];
+    __block NSUInteger remaining = gaps.count;
+    __block NSError *firstError = nil;
+    for (NSValue *const value in gaps) {
+        const NSRange gap = value.rangeValue;
+        const UInt64 lower = gap.location;
+        const UInt64 upper = NSMaxRange(gap) - 1;
+        ++_fetchCount;
+        [_session.timeSeries evaluateQuery:[[query fromSequence:lower] toSequence:upper]
+                               atTopicPath:topicPath
+                     JSONCompletionHandler:^(PTDiffusionJSONTimeSeriesQueryResult *const result, NSError *const error)
+        {
+            if (result) {
+                [self mergeResult:result intoSeries:series lower:lower upper:upper];
+            } else if (!firstError) {
+                firstError = error;
+            }
+            if (0 == --remaining) {
+                completionHandler(firstError ? nil : [series eventsInRange:range], firstError);
+            }
+        }];
+    }
+}
+
+
+- (void)lastEventsAtTopicPath:(NSString *const)topicPath
+                        count:(const UInt64)count
+            completionHandler:(void (^const)(NSArray<PTDiffusionJSONTimeSeriesEvent *> *, NSError *))completionHandler {
+    PTDiffusionTimeSeriesRangeQuery *const query = [[PTDiffusionTimeSeriesRangeQuery new] fromLastWithCount:count];
+    [self lastEventsAtTopicPath:topicPath
+                          query:query
+                           test:^BOOL(PTDiffusionJSONTimeSeriesEvent *const event, const NSUInteger collected) {
+        return collected < count;
+    }
+              completionHandler:completionHandler];
+}
+
+
+- (void)lastEventsAtTopicPath:(NSString *const)topicPath
+                 timeInterval:(const NSTimeInterval)timeInterval
+            completionHandler:(void (^const)(NSArray<PTDiffusionJSONTimeSeriesEvent *> *, NSError *))completionHandler {
+    PTDiffusionTimeSeriesRangeQuery *const query = [[PTDiffusionTimeSeriesRangeQuery new] fromLastWithTimeInterval:timeInterval];
+    TimeSeriesEventCacheSeries *const series = _series[topicPath];
+    const SInt64 threshold = series.latestTimestamp - (SInt64)(timeInterval * 1000.0);
+    [self lastEventsAtTopicPath:topicPath
+                          query:query
+                           test:^BOOL(PTDiffusionJSONTimeSeriesEvent *const event, const NSUInteger collected) {
+        return event.originalEvent.timestamp >= threshold;
+    }
+              completionHandler:completionHandler];
+}
+
+
+/**
+ Answers a query anchored at the end of the series locally if the stream has
+ kept the cache current back far enough, otherwise evaluates it and merges
+ the result.
+ */
+- (void)lastEventsAtTopicPath:(NSString *const)topicPath
+                        query:(PTDiffusionTimeSeriesRangeQuery *const)query
+                         test:(BOOL (^const)(PTDiffusionJSONTimeSeriesEvent *, NSUInteger))test
+            completionHandler:(void (^const)(NSArray<PTDiffusionJSONTimeSeriesEvent *> *, NSError *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Caches are confined to the main queue");
+    TimeSeriesEventCacheSeries *const series = [self seriesForTopicPath:topicPath];
+    NSArray<PTDiffusionJSONTimeSeriesEvent *> *const events = [series latestEventsPassingTest:test];
+    if (events) {
+        ++_hitCount;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(events, nil);
+        });
+        return;
+    }
+
+    ++_fetchCount;
+    [_session.timeSeries evaluateQuery:query
+                           atTopicPath:topicPath
+                 JSONCompletionHandler:^(PTDiffusionJSONTimeSeriesQueryResult *const result, NSError *const error)
+    {
+        if (!result) {
+            completionHandler(nil, error);
+            return;
+        }
+        NSArray<PTDiffusionJSONTimeSeriesEvent *> *const resultEvents = result.jsonEvents;
+        if (resultEvents.count > 0) {
+            [self mergeResult:result
+                   intoSeries:series
+                        lower:resultEvents.firstObject.originalEvent.sequence
+                        upper:INT64_MAX];
+        }
+        completionHandler(resultEvents, nil);
+    }];
+}
+
+
+#pragma mark - PTDiffusionJSONTimeSeriesEventValueStreamDelegate
+
+- (void)          diffusionStream:(PTDiffusionValueStream *const)stream
+     didUpdateTimeSeriesTopicPath:(NSString *const)topicPath
+                    specification:(PTDiffusionTopicSpecification *const)specification
+                     oldJSONEvent:(PTDiffusionJSONTimeSeriesEvent *const)oldJsonEvent
+                     newJSONEvent:(PTDiffusionJSONTimeSeriesEvent *const)newJsonEvent {
+    TimeSeriesEventCacheSeries *const series = [self seriesForTopicPath:topicPath];
+    // An edit can only be applied if the cache knows the value it replaces.
+    const UInt64 original = newJsonEvent.originalEvent.sequence;
+    if (!newJsonEvent.isEditEvent || [series.covered containsIndex:(NSUInteger)original]) {
+        [series addEvent:newJsonEvent];
+    }
+    // Events arrive in sequence, so each one extends the covered range ending
+    // at the previous one.
+    [series.covered addIndex:(NSUInteger)newJsonEvent.sequence];
+    series.live = YES;
+    series.latestSequence = newJsonEvent.sequence;
+    series.latestTimestamp = newJsonEvent.timestamp;
+    [series evictToCount:_maximumEventsPerTopic];
+}
+
+
+- (void)     diffusionStream:(PTDiffusionStream *const)stream
+     didSubscribeToTopicPath:(NSString *const)topicPath
+               specification:(PTDiffusionTopicSpecification *const)specification {
+}
+
+
+- (void)         diffusionStream:(PTDiffusionStream *const)stream
+     didUnsubscribeFromTopicPath:(NSString *const)topicPath
+                   specification:(PTDiffusionTopicSpecification *const)specification
+                          reason:(const PTDiffusionTopicUnsubscriptionReason)reason {
+    [self invalidateTopicPath:topicPath];
+}
+
+
+- (void)diffusionStream:(PTDiffusionStream *const)stream didFailWithError:(NSError *const)error {
+    [_series removeAllObjects];
+}
+
+
+- (void)diffusionDidCloseStream:(PTDiffusionStream *const)stream {
+    [_series removeAllObjects];
+}
+
+@end
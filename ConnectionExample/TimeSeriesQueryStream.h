@@ -0,0 +1,137 @@
+//
+//  TimeSeriesQueryStream.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+@class TimeSeriesQueryStream;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Evaluates one page of a range query. Implementations call the completion
+ handler with the result of one of the (typed) evaluateQuery: methods of
+ PTDiffusionTimeSeriesFeature.
+ */
+typedef void (^TimeSeriesQueryStreamPageEvaluator)(PTDiffusionTimeSeriesRangeQuery *query,
+    void (^completionHandler)(PTDiffusionTimeSeriesQueryResult * _Nullable result, NSError * _Nullable error));
+
+@protocol TimeSeriesQueryStreamDelegate <NSObject>
+
+/**
+ Called once for each event selected, in the order of the query result.
+ */
+- (void)timeSeriesQueryStream:(TimeSeriesQueryStream *)stream didReceiveEvent:(PTDiffusionTimeSeriesEvent *)event;
+
+/**
+ Called once after the last event has been delivered.
+ */
+- (void)timeSeriesQueryStreamDidComplete:(TimeSeriesQueryStream *)stream;
+
+/**
+ Called if evaluating a page fails. No further messages are sent to the
+ delegate.
+ */
+- (void)timeSeriesQueryStream:(TimeSeriesQueryStream *)stream didFailWithError:(NSError *)error;
+
+@end
+
+/**
+ Walks a time series forwards page by page and delivers its events to a
+ delegate one at a time.
+
+ Each page is a query for the next pageSize events after the last one
+ delivered, so a range of any length can be replayed without a single
+ PTDiffusionTimeSeriesQueryResult holding all of it. Pages are pipelined as
+ with FetchStream; see PagePipeline.
+ */
+@interface TimeSeriesQueryStream : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @param query A value range or edit range query. Its anchor (for example
+ PTDiffusionTimeSeriesRangeQuery#fromDate: or PTDiffusionTimeSeriesRangeQuery#fromSequence:)
+ sets where the stream starts. Its span and limit are replaced by the stream;
+ use endSequence and endDate to bound the range. Edit range queries are paged
+ by original event and each edit is delivered with its original; a page of
+ pageSize events that holds no new original event ends the stream.
+ @param pageSize The number of events requested for each page. Must be below
+ any limit the topic places on query results.
+ @param pageEvaluator Evaluates each page; see JSONPageEvaluatorWithSession:topicPath:
+ @param delegate Receives the events. Held strongly until the stream
+ completes, fails or is cancelled.
+ */
+- (instancetype)initWithQuery:(PTDiffusionTimeSeriesRangeQuery *)query
+                     pageSize:(UInt32)pageSize
+                pageEvaluator:(TimeSeriesQueryStreamPageEvaluator)pageEvaluator
+                     delegate:(id<TimeSeriesQueryStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
++ (TimeSeriesQueryStreamPageEvaluator)JSONPageEvaluatorWithSession:(PTDiffusionSession *)session
+                                                         topicPath:(NSString *)topicPath;
+
++ (TimeSeriesQueryStreamPageEvaluator)int64PageEvaluatorWithSession:(PTDiffusionSession *)session
+                                                          topicPath:(NSString *)topicPath;
+
++ (TimeSeriesQueryStreamPageEvaluator)doublePageEvaluatorWithSession:(PTDiffusionSession *)session
+                                                           topicPath:(NSString *)topicPath;
+
++ (TimeSeriesQueryStreamPageEvaluator)stringPageEvaluatorWithSession:(PTDiffusionSession *)session
+                                                           topicPath:(NSString *)topicPath;
+
+/**
+ The events of a query result of any of the typed PTDiffusionTimeSeriesQueryResult
+ subclasses.
+ */
++ (NSArray<PTDiffusionTimeSeriesEvent *> *)eventsOfQueryResult:(PTDiffusionTimeSeriesQueryResult *)result;
+
+/**
+ The last sequence number to deliver, inclusive, compared with the sequence of
+ the original event. Defaults to INT64_MAX.
+ */
+@property (nonatomic) UInt64 endSequence;
+
+/**
+ If set, the stream completes at the first original event with a later
+ timestamp. Edit events are delivered with their original, whatever their own
+ timestamp.
+ */
+@property (nonatomic, nullable) NSDate *endDate;
+
+/**
+ The maximum number of pages held at once. Defaults to 2 and must be at least 1;
+ a value of 1 disables pipelining.
+ */
+@property (nonatomic) NSUInteger maximumBufferedPages;
+
+/**
+ The serial queue on which the delegate is sent messages. Defaults to the main
+ queue.
+ */
+@property (nonatomic) dispatch_queue_t delegateQueue;
+
+/**
+ The number of events delivered so far.
+ */
+@property (atomic, readonly) NSUInteger eventCount;
+
+/**
+ Sends the first page query. Must be called on the main queue, once.
+ */
+- (void)start;
+
+/**
+ Stops the stream. The delegate is sent no further messages after the event
+ currently being delivered, if any.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,212 @@
+//
+//  TimeSeriesQueryStream.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "TimeSeriesQueryStream.h"
+#import "PagePipeline.h"
+
+
+@interface TimeSeriesQueryStream ()
+
+@property (atomic) BOOL cancelled;
+@property (atomic, nullable) PagePipeline *pipeline;
+@property (atomic, readwrite) NSUInteger eventCount;
+
+@end
+
+@implementation TimeSeriesQueryStream {
+    // All state below is confined to the main queue, which is where the
+    // Diffusion client calls query completion handlers.
+    PTDiffusionTimeSeriesRangeQuery *_query;
+    UInt32 _pageSize;
+    TimeSeriesQueryStreamPageEvaluator _pageEvaluator;
+    id<TimeSeriesQueryStreamDelegate> _delegate;
+    // The highest original event sequence delivered so far.
+    UInt64 _lastOriginalSequence;
+    BOOL _anchored;
+}
+
+
+- (instancetype)initWithQuery:(PTDiffusionTimeSeriesRangeQuery *const)query
+                     pageSize:(const UInt32)pageSize
+                pageEvaluator:(const TimeSeriesQueryStreamPageEvaluator)pageEvaluator
+                     delegate:(const id<TimeSeriesQueryStreamDelegate>)delegate {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    if (0 == pageSize) {
+        [NSException raise:NSInvalidArgumentException format:@"Page size must be greater than zero"];
+    }
+    _query = [query copy];
+    _pageSize = pageSize;
+    _pageEvaluator = [pageEvaluator copy];
+    _delegate = delegate;
+    _endSequence = INT64_MAX;
+    _maximumBufferedPages = 2;
+    _delegateQueue = dispatch_get_main_queue();
+    return self;
+}
+
+
++ (TimeSeriesQueryStreamPageEvaluator)JSONPageEvaluatorWithSession:(PTDiffusionSession *const)session
+                                                         topicPath:(NSString *const)topicPath {
+    NSString *const path = [topicPath copy];
+    return ^(PTDiffusionTimeSeriesRangeQuery *const query, void (^const completionHandler)(PTDiffusionTimeSeriesQueryResult *, NSError *)) {
+        [session.timeSeries evaluateQuery:query atTopicPath:path JSONCompletionHandler:completionHandler];
+    };
+}
+
+
++ (TimeSeriesQueryStreamPageEvaluator)int64PageEvaluatorWithSession:(PTDiffusionSession *const)session
+                                                          topicPath:(NSString *const)topicPath {
+    NSString *const path = [topicPath copy];
+    return ^(PTDiffusionTimeSeriesRangeQuery *const query, void (^const completionHandler)(PTDiffusionTimeSeriesQueryResult *, NSError *)) {
+        [session.timeSeries evaluateQuery:query atTopicPath:path int64NumberCompletionHandler:completionHandler];
+    };
+}
+
+
++ (TimeSeriesQueryStreamPageEvaluator)doublePageEvaluatorWithSession:(PTDiffusionSession *const)session
+                                                           topicPath:(NSString *const)topicPath {
+    NSString *const path = [topicPath copy];
+    return ^(PTDiffusionTimeSeriesRangeQuery *const query, void (^const completionHandler)(PTDiffusionTimeSeriesQueryResult *, NSError *)) {
+        [session.timeSeries evaluateQuery:query atTopicPath:path doubleFloatNumberCompletionHandler:completionHandler];
+    };
+}
+
+
++ (TimeSeriesQueryStreamPageEvaluator)stringPageEvaluatorWithSession:(PTDiffusionSession *const)session
+                                                           topicPath:(NSString *const)topicPath {
+    NSString *const path = [topicPath copy];
+    return ^(PTDiffusionTimeSeriesRangeQuery *const query, void (^const completionHandler)(PTDiffusionTimeSeriesQueryResult *, NSError *)) {
+        [session.timeSeries evaluateQuery:query atTopicPath:path stringCompletionHandler:completionHandler];
+    };
+}
+
+
++ (NSArray<PTDiffusionTimeSeriesEvent *> *)eventsOfQueryResult:(PTDiffusionTimeSeriesQueryResult *const)result {
+    if ([result isKindOfClass:PTDiffusionJSONTimeSeriesQueryResult.class]) {
+        return ((PTDiffusionJSONTimeSeriesQueryResult *)result).jsonEvents;
+    }
+    if ([result isKindOfClass:PTDiffusionNumberTimeSeriesQueryResult.class]) {
+        return ((PTDiffusionNumberTimeSeriesQueryResult *)result).numberEvents;
+    }
+    if ([result isKindOfClass:PTDiffusionStringTimeSeriesQueryResult.class]) {
+        return ((PTDiffusionStringTimeSeriesQueryResult *)result).stringEvents;
+    }
+    if ([result isKindOfClass:PTDiffusionBinaryTimeSeriesQueryResult.class]) {
+        return ((PTDiffusionBinaryTimeSeriesQueryResult *)result).binaryEvents;
+    }
+    if ([result isKindOfClass:PTDiffusionRecordV2TimeSeriesQueryResult.class]) {
+        return ((PTDiffusionRecordV2TimeSeriesQueryResult *)result).recordEvents;
+    }
+    [NSException raise:NSInvalidArgumentException format:@"Unsupported query result: %@", result.class];
+    return @[];
+}
+
+
+- (void)setMaximumBufferedPages:(const NSUInteger)maximumBufferedPages {
+    if (0 == maximumBufferedPages) {
+        [NSException raise:NSInvalidArgumentException format:@"At least one page must be buffered"];
+    }
+    _maximumBufferedPages = maximumBufferedPages;
+}
+
+
+- (void)start {
+    NSAssert(NSThread.isMainThread, @"Streams must be started on the main queue");
+    if (self.pipeline) {
+        [NSException raise:NSInternalInconsistencyException format:@"Stream already started"];
+    }
+    // The pipeline holds the delegate from here on.
+    id<TimeSeriesQueryStreamDelegate> const delegate = _delegate;
+    _delegate = nil;
+    PagePipeline *const pipeline = [[PagePipeline alloc] initWithPageRequester:^(const PagePipelinePageHandler pageHandler) {
+        [self evaluateNextPageWithHandler:pageHandler];
+    } itemHandler:^(PTDiffusionTimeSeriesEvent *const event) {
+        [delegate timeSeriesQueryStream:self didReceiveEvent:event];
+        self.eventCount++;
+    } completionHandler:^{
+        [delegate timeSeriesQueryStreamDidComplete:self];
+    } failureHandler:^(NSError *const error) {
+        [delegate timeSeriesQueryStream:self didFailWithError:error];
+    }];
+    pipeline.maximumBufferedPages = _maximumBufferedPages;
+    pipeline.delegateQueue = _delegateQueue;
+    self.pipeline = pipeline;
+    if (self.cancelled) {
+        [pipeline cancel];
+    }
+    [pipeline start];
+}
+
+
+- (void)cancel {
+    self.cancelled = YES;
+    [self.pipeline cancel];
+}
+
+
+- (void)evaluateNextPageWithHandler:(const PagePipelinePageHandler)pageHandler {
+    // The first page keeps the caller's anchor; later pages start after the
+    // last original event delivered. limitWithCount: keeps the latest events
+    // of a range, not the earliest, so pages are bounded with a span instead.
+    PTDiffusionTimeSeriesRangeQuery *const anchored =
+        _anchored ? [_query fromSequence:_lastOriginalSequence + 1] : _query;
+    _pageEvaluator([anchored nextWithCount:_pageSize], ^(PTDiffusionTimeSeriesQueryResult *const result, NSError *const error) {
+        if (!result) {
+            pageHandler(nil, NO, error);
+            return;
+        }
+        NSArray<PTDiffusionTimeSeriesEvent *> *const events = [TimeSeriesQueryStream eventsOfQueryResult:result];
+        BOOL more = events.count >= self->_pageSize;
+        NSArray<PTDiffusionTimeSeriesEvent *> *const selected = [self selectEvents:events more:&more];
+        pageHandler(selected, more, nil);
+    });
+}
+
+
+/**
+ The events of a page whose original event is new and within the range.
+
+ Ranges are bounded, and pages anchored, on original events. Edit events can
+ have timestamps and sequences beyond those of later originals, and an edit
+ range query page carries every edit of the originals it selects, so edits
+ are kept or dropped with their original. Edits of an original delivered by an
+ earlier page are dropped when a later page selects them again.
+ */
+- (NSArray<PTDiffusionTimeSeriesEvent *> *)selectEvents:(NSArray<PTDiffusionTimeSeriesEvent *> *const)events
+                                                   more:(BOOL *const)more {
+    const SInt64 endTimestamp = _endDate ? (SInt64)(_endDate.timeIntervalSince1970 * 1000.0) : INT64_MAX;
+    const BOOL anchored = _anchored;
+    const UInt64 previousOriginalSequence = _lastOriginalSequence;
+    UInt64 lastOriginalSequence = previousOriginalSequence;
+    NSMutableArray<PTDiffusionTimeSeriesEvent *> *const selected = [NSMutableArray arrayWithCapacity:events.count];
+    for (PTDiffusionTimeSeriesEvent *const event in events) {
+        PTDiffusionTimeSeriesEventMetadata *const original = event.originalEvent;
+        if (anchored && original.sequence <= previousOriginalSequence) {
+            continue;
+        }
+        if (original.sequence > _endSequence || original.timestamp > endTimestamp) {
+            *more = NO;
+            continue;
+        }
+        lastOriginalSequence = MAX(lastOriginalSequence, original.sequence);
+        [selected addObject:event];
+    }
+
+    // A page that selects no new original event cannot move the anchor on.
+    if (0 == selected.count) {
+        *more = NO;
+    }
+    if (*more) {
+        _lastOriginalSequence = lastOriginalSequence;
+        _anchored = YES;
+    }
+    return selected;
+}
+
+@end
@@ -0,0 +1,112 @@
+//
+//  TopicTreeExplorer.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A node of the client side topic tree model. A node exists for every path that
+ is a topic or has topics below it, whether or not a topic is bound to the
+ path itself.
+ */
+@interface TopicTreeNode : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ The last part of the path, or the empty string for the root.
+ */
+@property (nonatomic, readonly) NSString *name;
+
+/**
+ The full topic path, or the empty string for the root.
+ */
+@property (nonatomic, readonly) NSString *path;
+
+@property (nonatomic, readonly, weak, nullable) TopicTreeNode *parent;
+
+/**
+ The specification of the topic at this path, or `nil` if there is no topic at
+ this path or it has not been discovered yet.
+ */
+@property (nonatomic, readonly, nullable) PTDiffusionTopicSpecification *specification;
+
+/**
+ `YES` once the children of this node have been fetched.
+ */
+@property (nonatomic, readonly, getter=isExpanded) BOOL expanded;
+
+/**
+ The children discovered so far, in path order. Complete once expanded.
+ */
+@property (nonatomic, readonly) NSArray<TopicTreeNode *> *children;
+
+@end
+
+
+/**
+ Builds a model of the topic tree one branch at a time.
+
+ Expanding a node fetches one result for each of its immediate children using
+ PTDiffusionFetchRequest#limitDeepBranches:limit:, paged so that nodes with a
+ very large number of children do not produce a single huge response. Each
+ node is fetched at most once: expanding a node that is already expanded
+ completes immediately, and concurrent expansions of the same node share one
+ fetch.
+
+ Instances are confined to the main queue.
+ */
+@interface TopicTreeExplorer : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ @param request The request used as the basis of every fetch, typically
+ `session.topics.fetchRequest`.
+ */
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *)request NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) TopicTreeNode *root;
+
+/**
+ The page size used when expanding a node. Defaults to 1000.
+ */
+@property (nonatomic) UInt32 pageSize;
+
+/**
+ The number of fetches issued so far.
+ */
+@property (nonatomic, readonly) NSUInteger fetchCount;
+
+/**
+ Returns the node for a path if it has been discovered, otherwise `nil`.
+ */
+- (nullable TopicTreeNode *)nodeAtPath:(NSString *)path;
+
+/**
+ Fetches the children of the node at the given path, unless they are already
+ known. Pass the empty string to expand the root. The completion handler is
+ called on the main queue.
+ */
+- (void)expandPath:(NSString *)path
+ completionHandler:(void (^)(TopicTreeNode * _Nullable node, NSError * _Nullable error))completionHandler;
+
+/**
+ The split-path selector for a path and its descendants, as used by
+ expandPath:completionHandler:. Each part of the path is quoted as a regular
+ expression.
+ */
++ (NSString *)branchSelectorExpressionForPath:(NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
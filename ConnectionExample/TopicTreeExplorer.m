@@ -0,0 +1,267 @@
+//
+//  TopicTreeExplorer.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "TopicTreeExplorer.h"
+#import "FetchStream.h"
+
+
+@interface TopicTreeNode ()
+
+@property (nonatomic, readwrite, nullable) PTDiffusionTopicSpecification *specification;
+@property (nonatomic, readwrite, getter=isExpanded) BOOL expanded;
+@property (nonatomic, readonly) NSUInteger depth;
+
+- (instancetype)initWithName:(NSString *)name parent:(nullable TopicTreeNode *)parent NS_DESIGNATED_INITIALIZER;
+
+- (TopicTreeNode *)childNamed:(NSString *)name;
+
+- (TopicTreeNode *)placeholderChildNamed:(NSString *)name;
+
+- (nullable TopicTreeNode *)existingChildNamed:(NSString *)name;
+
+- (void)setChildren:(NSArray<TopicTreeNode *> *)children;
+
+@end
+
+@implementation TopicTreeNode {
+    NSMutableDictionary<NSString *, TopicTreeNode *> *_childrenByName;
+    NSMutableArray<TopicTreeNode *> *_children;
+    // Nodes for paths asked for before this node was expanded. They are not
+    // children until a fetch finds them, when childNamed: adopts them.
+    NSMutableDictionary<NSString *, TopicTreeNode *> *_placeholdersByName;
+}
+
+- (instancetype)initWithName:(NSString *const)name parent:(TopicTreeNode *const)parent {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _name = [name copy];
+    _parent = parent;
+    if (parent) {
+        _path = parent.depth > 0 ? [NSString stringWithFormat:@"%@/%@", parent.path, name] : _name;
+        _depth = parent.depth + 1;
+    } else {
+        _path = @"";
+    }
+    _childrenByName = [NSMutableDictionary new];
+    _children = [NSMutableArray new];
+    _placeholdersByName = [NSMutableDictionary new];
+    return self;
+}
+
+- (NSArray<TopicTreeNode *> *)children {
+    return [_children copy];
+}
+
+- (TopicTreeNode *)existingChildNamed:(NSString *const)name {
+    return _childrenByName[name];
+}
+
+- (TopicTreeNode *)childNamed:(NSString *const)name {
+    TopicTreeNode *child = _childrenByName[name];
+    if (!child) {
+        child = _placeholdersByName[name];
+        if (child) {
+            [_placeholdersByName removeObjectForKey:name];
+        } else {
+            child = [[TopicTreeNode alloc] initWithName:name parent:self];
+        }
+        _childrenByName[name] = child;
+        [_children addObject:child];
+    }
+    return child;
+}
+
+- (TopicTreeNode *)placeholderChildNamed:(NSString *const)name {
+    TopicTreeNode *child = _childrenByName[name] ?: _placeholdersByName[name];
+    if (!child) {
+        child = [[TopicTreeNode alloc] initWithName:name parent:self];
+        _placeholdersByName[name] = child;
+    }
+    return child;
+}
+
+- (void)setChildren:(NSArray<TopicTreeNode *> *const)children {
+    [_children setArray:children];
+    [_childrenByName removeAllObjects];
+    for (TopicTreeNode *const child in children) {
+        _childrenByName[child.name] = child;
+    }
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p path=\"%@\" children=%lu%@>",
+            NSStringFromClass(self.class), (void *)self, _path,
+            (unsigned long)_children.count, _expanded ? @"" : @"+"];
+}
+
+@end
+
+
+/**
+ Collects the sampled results of one node expansion.
+ */
+@interface TopicTreeExpansion : NSObject <FetchStreamDelegate>
+
+@property (nonatomic) TopicTreeNode *node;
+@property (nonatomic, readonly) NSMutableArray<TopicTreeNode *> *children;
+@property (nonatomic, readonly) NSMutableArray<void (^)(TopicTreeNode *, NSError *)> *completionHandlers;
+
+@end
+
+@implementation TopicTreeExpansion
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _children = [NSMutableArray new];
+        _completionHandlers = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (void)fetchStream:(FetchStream *const)stream didFetchTopicResult:(PTDiffusionFetchTopicResult *const)result {
+    NSArray<NSString *> *const parts = [result.path componentsSeparatedByString:@"/"];
+    if (parts.count == _node.depth) {
+        // The node itself.
+        _node.specification = result.specification;
+        return;
+    }
+    // One result per child branch: either the child itself or, if there is no
+    // topic at the child path, its first descendant.
+    TopicTreeNode *const child = [_node childNamed:parts[_node.depth]];
+    if (_children.lastObject != child) {
+        [_children addObject:child];
+    }
+    if (parts.count == _node.depth + 1) {
+        child.specification = result.specification;
+    }
+}
+
+- (void)fetchStreamDidComplete:(FetchStream *const)stream {
+    [_node setChildren:_children];
+    _node.expanded = YES;
+    for (void (^const completionHandler)(TopicTreeNode *, NSError *) in _completionHandlers) {
+        completionHandler(_node, nil);
+    }
+}
+
+- (void)fetchStream:(FetchStream *const)stream didFailWithError:(NSError *const)error {
+    for (void (^const completionHandler)(TopicTreeNode *, NSError *) in _completionHandlers) {
+        completionHandler(nil, error);
+    }
+}
+
+@end
+
+
+@implementation TopicTreeExplorer {
+    PTDiffusionFetchRequest *_request;
+    NSMutableDictionary<NSString *, TopicTreeExpansion *> *_expansions;
+}
+
+
+- (instancetype)initWithRequest:(PTDiffusionFetchRequest *const)request {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _request = request;
+    _root = [[TopicTreeNode alloc] initWithName:@"" parent:nil];
+    _pageSize = 1000;
+    _expansions = [NSMutableDictionary new];
+    return self;
+}
+
+
+- (TopicTreeNode *)nodeAtPath:(NSString *const)path {
+    TopicTreeNode *node = _root;
+    if (0 == path.length) {
+        return node;
+    }
+    for (NSString *const name in [path componentsSeparatedByString:@"/"]) {
+        node = [node existingChildNamed:name];
+        if (!node) {
+            return nil;
+        }
+    }
+    return node;
+}
+
+
+- (TopicTreeNode *)nodeCreatingPath:(NSString *const)path {
+    TopicTreeNode *node = _root;
+    if (0 == path.length) {
+        return node;
+    }
+    // Placeholders, so that a parent's children stay those fetched for it.
+    for (NSString *const name in [path componentsSeparatedByString:@"/"]) {
+        node = [node placeholderChildNamed:name];
+    }
+    return node;
+}
+
+
+- (void)expandPath:(NSString *const)path
+ completionHandler:(void (^const)(TopicTreeNode *, NSError *))completionHandler {
+    NSAssert(NSThread.isMainThread, @"Explorers are confined to the main queue");
+    TopicTreeNode *const node = [self nodeCreatingPath:path];
+    if (node.expanded) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(node, nil);
+        });
+        return;
+    }
+
+    TopicTreeExpansion *expansion = _expansions[node.path];
+    if (expansion) {
+        [expansion.completionHandlers addObject:[completionHandler copy]];
+        return;
+    }
+
+    expansion = [TopicTreeExpansion new];
+    expansion.node = node;
+    [expansion.completionHandlers addObject:[completionHandler copy]];
+    NSString *const key = node.path;
+    [expansion.completionHandlers insertObject:^(TopicTreeNode *const n, NSError *const e) {
+        [self->_expansions removeObjectForKey:key];
+    } atIndex:0];
+    _expansions[key] = expansion;
+
+    // The root has depth 0 and its children are branches of depth 1.
+    NSString *const expression = [TopicTreeExplorer branchSelectorExpressionForPath:node.path];
+    PTDiffusionFetchRequest *const request =
+        [_request limitDeepBranches:(UInt32)node.depth + 1 limit:1];
+    FetchStream *const stream =
+        [[FetchStream alloc] initWithRequest:request
+                                    pageSize:_pageSize
+                                 pageFetcher:[self countingPageFetcher:[FetchStream pageFetcherWithTopicSelectorExpression:expression]]
+                                    delegate:expansion];
+    [stream start];
+}
+
+
++ (NSString *)branchSelectorExpressionForPath:(NSString *const)path {
+    if (0 == path.length) {
+        return @"?.//";
+    }
+    // Descendant qualifiers only apply to split-path and full-path patterns,
+    // not to path selectors.
+    NSMutableArray<NSString *> *const parts = [NSMutableArray new];
+    for (NSString *const part in [path componentsSeparatedByString:@"/"]) {
+        [parts addObject:[NSRegularExpression escapedPatternForString:part]];
+    }
+    return [NSString stringWithFormat:@"?%@//", [parts componentsJoinedByString:@"/"]];
+}
+
+
+- (FetchStreamPageFetcher)countingPageFetcher:(const FetchStreamPageFetcher)pageFetcher {
+    return ^(PTDiffusionFetchRequest *const request, void (^const completionHandler)(PTDiffusionFetchResult *, NSError *)) {
+        ++self->_fetchCount;
+        pageFetcher(request, completionHandler);
+    };
+}
+
+@end
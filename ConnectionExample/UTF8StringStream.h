@@ -0,0 +1,106 @@
+//
+//  UTF8StringStream.h
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "SubscriberStreamForwarder.h"
+
+@import Diffusion;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class UTF8StringValueStream;
+
+/**
+ The UTF-8 bytes of a string value. `bytes` is `NULL` if there is no value.
+ */
+typedef struct {
+    const char *bytes;
+    NSUInteger length;
+} UTF8StringSlice;
+
+
+@protocol UTF8StringValueStreamDelegate <PTDiffusionSubscriberStreamDelegate>
+
+/**
+ The slices are valid only for the duration of the call.
+ */
+- (void)utf8StringValueStream:(UTF8StringValueStream *)stream
+           didUpdateTopicPath:(NSString *)topicPath
+                specification:(PTDiffusionTopicSpecification *)specification
+                     oldValue:(UTF8StringSlice)oldValue
+                     newValue:(UTF8StringSlice)newValue;
+
+@end
+
+
+/**
+ Delivers the values of string topics as UTF-8 bytes, for consumers that
+ forward them to a UTF-8 sink without looking at them.
+
+ The client library decodes values into NSString before its stream delegate
+ is called. Where the string's own storage is already UTF-8, as it is for
+ ASCII values, the delegate is passed a view of that storage and nothing is
+ copied; otherwise the value is encoded into a buffer reused for every update.
+
+ Instances are confined to the main queue.
+ */
+@interface UTF8StringValueStream : SubscriberStreamForwarder
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithSubscriberDelegate:(id<PTDiffusionSubscriberStreamDelegate>)delegate NS_UNAVAILABLE;
+
+- (instancetype)initWithDelegate:(id<UTF8StringValueStreamDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, weak) id<UTF8StringValueStreamDelegate> delegate;
+
+/**
+ The UTF-8 bytes of a string, pointing into the string's own storage if it
+ has a UTF-8 representation, otherwise encoded into `buffer`, which is grown as
+ needed. Valid for as long as both are unchanged.
+ */
++ (UTF8StringSlice)sliceOfString:(nullable NSString *)string buffer:(NSMutableData *)buffer;
+
+@end
+
+
+/**
+ Sets a string topic from UTF-8 bytes through a PTDiffusionStringUpdateStream.
+
+ The client library only accepts NSString, so the bytes are copied into one;
+ for ASCII values this is a straight copy with no transcoding.
+
+ Instances are confined to the main queue.
+ */
+@interface UTF8StringUpdateStream : NSObject
+
++ (instancetype)new NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithUpdateStream:(PTDiffusionStringUpdateStream *)updateStream NS_DESIGNATED_INITIALIZER;
+
+/**
+ Uses PTDiffusionTopicUpdateFeature#stringUpdateStreamWithPath:
+ */
++ (instancetype)streamWithSession:(PTDiffusionSession *)session path:(NSString *)path;
+
+@property (nonatomic, readonly) PTDiffusionStringUpdateStream *updateStream;
+
+/**
+ As PTDiffusionStringUpdateStream#setValue:completionHandler:error:
+
+ @param bytes The value, or `NULL` for null.
+ @exception NSInvalidArgumentException If the bytes are not valid UTF-8.
+ */
+- (BOOL)setUTF8Bytes:(nullable const char *)bytes
+              length:(NSUInteger)length
+   completionHandler:(void (^)(PTDiffusionTopicCreationResult * _Nullable result, NSError * _Nullable error))completionHandler
+               error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,128 @@
+//
+//  UTF8StringStream.m
+//  ConnectionExample
+//
+//  Copyright © 2020 Pedro Loureiro. All rights reserved.
+//
+
+#import "UTF8StringStream.h"
+
+
+@interface UTF8StringValueStream () <PTDiffusionStringValueStreamDelegate>
+@end
+
+
+@implementation UTF8StringValueStream {
+    // Separate buffers, because both values are passed at once.
+    NSMutableData *_oldBuffer;
+    NSMutableData *_newBuffer;
+}
+
+
+- (instancetype)initWithDelegate:(id<UTF8StringValueStreamDelegate> const)delegate {
+    if (!(self = [super initWithSubscriberDelegate:delegate])) {
+        return nil;
+    }
+    _oldBuffer = [NSMutableData new];
+    _newBuffer = [NSMutableData new];
+    return self;
+}
+
+
+- (PTDiffusionValueStream *)createStream {
+    return [PTDiffusionPrimitive stringValueStreamWithDelegate:self];
+}
+
+
+- (id<UTF8StringValueStreamDelegate>)delegate {
+    return (id<UTF8StringValueStreamDelegate>)self.subscriberDelegate;
+}
+
+
++ (UTF8StringSlice)sliceOfString:(NSString *const)string buffer:(NSMutableData *const)buffer {
+    UTF8StringSlice slice;
+    if (!string) {
+        slice.bytes = NULL;
+        slice.length = 0;
+        return slice;
+    }
+
+    // CoreFoundation only exposes storage as UTF-8 for strings held as eight
+    // bit ASCII, in which case each character is one byte.
+    const CFStringRef cfString = (__bridge CFStringRef)string;
+    const char *const bytes = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+    if (bytes) {
+        slice.bytes = bytes;
+        slice.length = (NSUInteger)CFStringGetLength(cfString);
+        return slice;
+    }
+
+    const NSUInteger maximumLength = [string maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    if (buffer.length < maximumLength) {
+        buffer.length = maximumLength;
+    }
+    NSUInteger usedLength = 0;
+    [string getBytes:buffer.mutableBytes
+           maxLength:maximumLength
+          usedLength:&usedLength
+            encoding:NSUTF8StringEncoding
+             options:0
+               range:NSMakeRange(0, string.length)
+      remainingRange:NULL];
+    slice.bytes = buffer.bytes;
+    slice.length = usedLength;
+    return slice;
+}
+
+
+#pragma mark - PTDiffusionStringValueStreamDelegate
+
+- (void)diffusionStream:(PTDiffusionValueStream *const)stream
+     didUpdateTopicPath:(NSString *const)topicPath
+          specification:(PTDiffusionTopicSpecification *const)specification
+              oldString:(NSString *const)oldString
+              newString:(NSString *const)newString {
+    [self.delegate utf8StringValueStream:self
+                  didUpdateTopicPath:topicPath
+                       specification:specification
+                            oldValue:[UTF8StringValueStream sliceOfString:oldString buffer:_oldBuffer]
+                            newValue:[UTF8StringValueStream sliceOfString:newString buffer:_newBuffer]];
+}
+
+@end
+
+
+@implementation UTF8StringUpdateStream
+
+
+- (instancetype)initWithUpdateStream:(PTDiffusionStringUpdateStream *const)updateStream {
+    if (!(self = [super init])) {
+        return nil;
+    }
+    _updateStream = updateStream;
+    return self;
+}
+
+
++ (instancetype)streamWithSession:(PTDiffusionSession *const)session path:(NSString *const)path {
+    return [[self alloc] initWithUpdateStream:[session.topicUpdate stringUpdateStreamWithPath:path]];
+}
+
+
+- (BOOL)setUTF8Bytes:(const char *const)bytes
+              length:(const NSUInteger)length
+   completionHandler:(void (^const)(PTDiffusionTopicCreationResult *, NSError *))completionHandler
+               error:(NSError **const)error {
+    NSAssert(NSThread.isMainThread, @"Not on main thread");
+    NSString *value = nil;
+    if (bytes) {
+        // Copied, because the update stream keeps the value it was last set to.
+        value = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if (!value) {
+            [NSException raise:NSInvalidArgumentException format:@"Value is not valid UTF-8"];
+        }
+    }
+    return [_updateStream setValue:value completionHandler:completionHandler error:error];
+}
+
+@end
@@ -7,6 +7,13 @@
 //
 
 #import <XCTest/XCTest.h>
+#import "PriorityScheduler.h"
+#import "RequestBenchmark.h"
+#import "RecordV2ArenaBuilder.h"
+#import "RequestWindow.h"
+#import "ScalarUpdateStream.h"
+#import "TimeSeriesAppendBatch.h"
+#import "TopicTreeExplorer.h"
 
 @interface ConnectionExampleTests : XCTestCase
 
@@ -34,4 +41,230 @@
     }];
 }
 
+- (void)testTopicTreeExplorerBranchSelectors {
+    XCTAssertEqualObjects([TopicTreeExplorer branchSelectorExpressionForPath:@""], @"?.//");
+    XCTAssertEqualObjects([TopicTreeExplorer branchSelectorExpressionForPath:@"prices"], @"?prices//");
+    XCTAssertEqualObjects([TopicTreeExplorer branchSelectorExpressionForPath:@"prices/VOD.L"], @"?prices/VOD\\.L//");
+    XCTAssertEqualObjects([TopicTreeExplorer branchSelectorExpressionForPath:@"a(b)/c+d"], @"?a\\(b\\)/c\\+d//");
+}
+
+- (void)testPrioritySchedulerRunsEveryOperationWithLaneLimits {
+    // High is limited to one at a time, so claims park behind it while Normal
+    // and Low entries arrive.
+    PriorityScheduler *const scheduler = [[PriorityScheduler alloc] initWithSession:nil maximumOutstandingOperations:2];
+    [scheduler setMaximumOutstandingOperations:1 forPriority:PTDiffusionSendDeliveryPriority_High];
+
+    const PTDiffusionSendDeliveryPriority priorities[] = {
+        PTDiffusionSendDeliveryPriority_High,
+        PTDiffusionSendDeliveryPriority_High,
+        PTDiffusionSendDeliveryPriority_High,
+        PTDiffusionSendDeliveryPriority_Normal,
+        PTDiffusionSendDeliveryPriority_High,
+        PTDiffusionSendDeliveryPriority_Low,
+        PTDiffusionSendDeliveryPriority_Normal,
+    };
+    const NSUInteger count = sizeof(priorities) / sizeof(priorities[0]);
+    XCTestExpectation *const expectation = [self expectationWithDescription:@"Operations complete"];
+    expectation.expectedFulfillmentCount = count;
+    __block NSUInteger highOutstanding = 0;
+    for (NSUInteger i = 0; i < count; ++i) {
+        const BOOL high = PTDiffusionSendDeliveryPriority_High == priorities[i];
+        [scheduler performOperation:^(const dispatch_block_t done) {
+            if (high) {
+                XCTAssertEqual(++highOutstanding, (NSUInteger)1);
+            }
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_MSEC), dispatch_get_main_queue(), ^{
+                if (high) {
+                    --highOutstanding;
+                }
+                done();
+                [expectation fulfill];
+            });
+        } priority:priorities[i]];
+    }
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+
+    XCTAssertEqual([scheduler metricsForPriority:PTDiffusionSendDeliveryPriority_High].completedCount, (NSUInteger)4);
+    XCTAssertEqual([scheduler metricsForPriority:PTDiffusionSendDeliveryPriority_Normal].completedCount, (NSUInteger)2);
+    XCTAssertEqual([scheduler metricsForPriority:PTDiffusionSendDeliveryPriority_Low].completedCount, (NSUInteger)1);
+}
+
+- (void)testRequestPipeliningAgainstLocalResponder {
+    // 16 workers at 1ms each: throughput should level off once 16 or more
+    // requests are in flight. Timer jitter makes exact ratios unreliable, so
+    // only the ordering is checked.
+    RequestBenchmark *const benchmark =
+        [[RequestBenchmark alloc] initWithSender:[RequestBenchmark localResponderWithServiceTime:0.001 workers:16]];
+    benchmark.requestsPerRun = 2000;
+
+    XCTestExpectation *const expectation = [self expectationWithDescription:@"Benchmark complete"];
+    [benchmark runWithConcurrencyLevels:@[@1, @100, @1000]
+                      completionHandler:^(NSArray<RequestBenchmarkResult *> *const results) {
+        for (RequestBenchmarkResult *const result in results) {
+            XCTAssertEqual(result.errorCount, (NSUInteger)0);
+        }
+        const double serial = results[0].requestsPerSecond;
+        const double pipelined = results[1].requestsPerSecond;
+        const double saturated = results[2].requestsPerSecond;
+        XCTAssertGreaterThan(pipelined, serial * 2);
+        XCTAssertGreaterThanOrEqual(saturated, pipelined * 0.5);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:30.0 handler:nil];
+}
+
+- (void)testSustainedTimeSeriesAppendAgainstLocalAppender {
+    // 100 series of 500 ticks each, 1ms per append, up to 1000 appends in
+    // flight.
+    NSMutableDictionary<NSString *, NSArray *> *const valuesByTopicPath = [NSMutableDictionary new];
+    for (NSUInteger series = 0; series < 100; ++series) {
+        NSMutableArray<NSNumber *> *const values = [NSMutableArray new];
+        for (NSUInteger tick = 0; tick < 500; ++tick) {
+            [values addObject:@(tick)];
+        }
+        valuesByTopicPath[[NSString stringWithFormat:@"ticks/%lu", (unsigned long)series]] = values;
+    }
+
+    [self measureBlock:^{
+        RequestWindow *const window = [[RequestWindow alloc] initWithSession:nil maximumOutstandingRequests:1000];
+        XCTestExpectation *const expectation = [self expectationWithDescription:@"Appends complete"];
+        [TimeSeriesAppendBatch appendValuesByTopicPath:valuesByTopicPath
+                                              appender:[TimeSeriesAppendBatch localAppenderWithLatency:0.001]
+                                                window:window
+                                     completionHandler:^(TimeSeriesAppendBatchResult *const result)
+        {
+            XCTAssertEqual(result.errorCount, (NSUInteger)0);
+            XCTAssertEqual(result.eventCount, (NSUInteger)50000);
+            for (NSString *const topicPath in result.topicPaths) {
+                const UInt64 *const sequences = [result sequencesForTopicPath:topicPath];
+                for (NSUInteger i = 0; i < 500; ++i) {
+                    XCTAssertEqual(sequences[i], (UInt64)i);
+                }
+            }
+            [expectation fulfill];
+        }];
+        [self waitForExpectationsWithTimeout:60.0 handler:nil];
+    }];
+}
+
+- (void)testRecordV2ArenaBuilderAgainstRecordV2Builder {
+    // Price board records: a symbol, a venue that is often empty, two integers
+    // and two 2dp decimals, the second a change that runs from -1.00 to 1.00.
+    static const NSUInteger recordCount = 10000;
+
+    PTDiffusionRecordV2Builder *const builder = [PTDiffusionRecordV2Builder new];
+    RecordV2ArenaBuilder *const arena = [[RecordV2ArenaBuilder alloc] initWithCapacity:256];
+    for (NSUInteger i = 0; i < recordCount; ++i) {
+        @autoreleasepool {
+            const int64_t change = (int64_t)(i % 201) - 100;
+            const uint64_t magnitude = (uint64_t)llabs(change);
+            [builder clear];
+            [builder addFields:@[
+                @"VOD.L",
+                0 == i % 3 ? @"XLON" : @"",
+                [NSString stringWithFormat:@"%lu", (unsigned long)i],
+                [NSString stringWithFormat:@"%lld", -(long long)i],
+                [NSString stringWithFormat:@"%lu.%02lu", (unsigned long)(i / 100), (unsigned long)(i % 100)],
+                [NSString stringWithFormat:@"%s%llu.%02llu", change < 0 ? "-" : "", magnitude / 100, magnitude % 100],
+            ]];
+
+            [arena reset];
+            [arena addCString:"VOD.L"];
+            [arena addCString:0 == i % 3 ? "XLON" : ""];
+            [arena addInt64:(int64_t)i];
+            [arena addInt64:-(int64_t)i];
+            [arena addUnscaledDecimal:(int64_t)i scale:2];
+            [arena addDouble:change / 100.0 scale:2];
+
+            XCTAssertEqualObjects([arena build].data, [builder build].data, @"Record %lu", (unsigned long)i);
+        }
+    }
+
+    // Several records in one value, with empty fields at either end.
+    [builder clear];
+    [builder addRecordWithFields:@[@"", @"a"]];
+    [builder addRecordWithFields:@[@"b", @""]];
+    [builder addRecordWithFields:@[@""]];
+    [arena reset];
+    [arena addString:@""];
+    [arena addCString:"a"];
+    [arena beginRecord];
+    [arena addString:@"b"];
+    [arena addUTF8Bytes:"" length:0];
+    [arena beginRecord];
+    [arena addCString:""];
+    XCTAssertEqualObjects([arena build].data, [builder build].data);
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < recordCount; ++i) {
+            @autoreleasepool {
+                [arena reset];
+                [arena addCString:"VOD.L"];
+                [arena addCString:0 == i % 3 ? "XLON" : ""];
+                [arena addInt64:(int64_t)i];
+                [arena addInt64:-(int64_t)i];
+                [arena addUnscaledDecimal:(int64_t)i scale:2];
+                [arena addUnscaledDecimal:(int64_t)(i % 201) - 100 scale:2];
+                [arena build];
+            }
+        }
+    }];
+}
+
+- (void)testRecordV2BuilderBaseline {
+    // The same records as testRecordV2ArenaBuilderAgainstRecordV2Builder
+    // measures, encoded with PTDiffusionRecordV2Builder for comparison.
+    static const NSUInteger recordCount = 10000;
+
+    PTDiffusionRecordV2Builder *const builder = [PTDiffusionRecordV2Builder new];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < recordCount; ++i) {
+            @autoreleasepool {
+                const int64_t change = (int64_t)(i % 201) - 100;
+                const uint64_t magnitude = (uint64_t)llabs(change);
+                [builder clear];
+                [builder addFields:@[
+                    @"VOD.L",
+                    0 == i % 3 ? @"XLON" : @"",
+                    [NSString stringWithFormat:@"%lu", (unsigned long)i],
+                    [NSString stringWithFormat:@"%lld", -(long long)i],
+                    [NSString stringWithFormat:@"%lu.%02lu", (unsigned long)(i / 100), (unsigned long)(i % 100)],
+                    [NSString stringWithFormat:@"%s%llu.%02llu", change < 0 ? "-" : "", magnitude / 100, magnitude % 100],
+                ]];
+                [builder build];
+            }
+        }
+    }];
+}
+
+- (void)testScalarUpdateStreamReusesBoxOfRepeatedValue {
+    // A 2dp price that moves on one tick in four.
+    static const NSUInteger tickCount = 1000;
+    void (^const completionHandler)(PTDiffusionTopicCreationResult *, NSError *) =
+        ^(PTDiffusionTopicCreationResult *const result, NSError *const error) {
+            XCTAssertNil(error);
+        };
+
+    NSMutableArray<NSNumber *> *const sent = [NSMutableArray new];
+    const ScalarUpdateSink localSink = [ScalarUpdateStream localSink];
+    ScalarUpdateStream *const stream = [[ScalarUpdateStream alloc] initWithSink:
+        ^BOOL(NSNumber *const value, void (^const handler)(PTDiffusionTopicCreationResult *, NSError *), NSError **const error) {
+            [sent addObject:value];
+            return localSink(value, handler, error);
+        }];
+    for (NSUInteger i = 0; i < tickCount; ++i) {
+        XCTAssertTrue([stream setDouble:100.0 + (i / 4) * 0.01 completionHandler:completionHandler error:NULL]);
+    }
+
+    XCTAssertEqual(stream.reusedCount, tickCount - tickCount / 4);
+    XCTAssertEqual(stream.doubleValue, 100.0 + ((tickCount - 1) / 4) * 0.01);
+    XCTAssertEqual(sent.count, tickCount);
+    for (NSUInteger i = 0; i < tickCount; ++i) {
+        XCTAssertEqual(sent[i].doubleValue, 100.0 + (i / 4) * 0.01);
+        if (0 != i % 4) {
+            XCTAssertTrue(sent[i] == sent[i - 1], @"Tick %lu was boxed again", (unsigned long)i);
+        }
+    }
+}
+
 @end